@@ -272,6 +272,9 @@ class IMGUIQuakeConsole : public MultiStream
 
     float fontScale = 1.2f; ///< text scale for the console widget window
 
+    int completionRows = 8;          ///< rows the completion popup shows before it scrolls
+    int completionHelpLength = 80;   ///< longest help snippet shown next to a completion candidate
+
     void ClearLog(); ///< Clear the ostream
 
     void render(const char *title, bool& p_open); ///< Renders an IMGUI window implementation of the console
@@ -284,6 +287,35 @@ class IMGUIQuakeConsole : public MultiStream
     void historyCallback(ImGuiInputTextCallbackData *data);
 
     void textCompletionCallback(ImGuiInputTextCallbackData *data);
+
+    /// while the completion popup is open, follows the input line with the candidates for what's been typed
+    void textEditCallback(ImGuiInputTextCallbackData *data);
+
+    /// puts a candidate clicked in the popup into the line, and keeps polling a completion that's still pending
+    void textAlwaysCallback(ImGuiInputTextCallbackData *data);
+
+    /// replaces the word being completed with a candidate
+    void acceptCompletion(ImGuiInputTextCallbackData *data, std::size_t index);
+
+    /// asks the console for the candidates at the cursor again
+    void refreshCompletion(ImGuiInputTextCallbackData *data);
+
+    /// draws the candidates over the bottom of the scrollback, right above the input line.  Only the visible rows are submitted
+    void renderCompletionPopup();
+
+    Virtuoso::QuakeStyleConsole::CompletionResult completion; ///< the candidates the popup shows
+
+    /// state of the completion popup, which lists the candidates instead of printing them into the scrollback
+    struct CompletionPopup
+    {
+        bool open = false;
+        bool hovered = false;          ///< the mouse was over it last frame, so the input line losing focus to a click doesn't close it
+        bool scrollToSelected = false; ///< the selection moved, so bring it into view
+        std::size_t selected = 0;      ///< row picked with the arrow keys, which tab accepts
+        int accept = -1;               ///< row clicked with the mouse, put into the line by the next input callback
+    };
+
+    CompletionPopup popup;
 };
 
 // -------------------------------------------
@@ -390,6 +422,12 @@ inline IMGUIQuakeConsole::IMGUIQuakeConsole()
 
     is.textCallbacks[ImGuiInputTextFlags_CallbackHistory] = [this](ImGuiInputTextCallbackData *data) { this->historyCallback(data); };
 
+    is.textCallbacks[ImGuiInputTextFlags_CallbackEdit] = [this](ImGuiInputTextCallbackData *data) { this->textEditCallback(data); };
+
+    is.textCallbacks[ImGuiInputTextFlags_CallbackAlways] = [this](ImGuiInputTextCallbackData *data) { this->textAlwaysCallback(data); };
+
+    is.input_text_flags |= ImGuiInputTextFlags_CallbackEdit | ImGuiInputTextFlags_CallbackAlways;
+
     con.bindMemberCommand("consoleClear", *this, &IMGUIQuakeConsole::ClearLog, "Clear the console");
     con.bindCVar("consoleTextScale", fontScale);
 
@@ -441,6 +479,26 @@ inline void IMGUIQuakeConsole::render(const char *title, bool& p_open)
 
     bool copy_to_clipboard = ImGui::SmallButton("Copy");
 
+    // running indicator for async commands, with the job list on hover
+    if (std::size_t jobCount = con.jobCount())
+    {
+        static const char spinner[] = "|/-\\";
+
+        ImGui::SameLine();
+        ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.2f, 1.0f), "%c %d job%s running", spinner[int(ImGui::GetTime() * 8.0) & 3], int(jobCount), (jobCount == 1) ? "" : "s");
+
+        if (ImGui::IsItemHovered())
+        {
+            ImGui::BeginTooltip();
+            for (const std::shared_ptr<Virtuoso::ConsoleJob> &job : con.jobList())
+            {
+                ImGui::Text("%u  %.1fs  %s", job->id(), job->seconds(), job->name().c_str());
+            }
+            ImGui::TextDisabled("jobs cancel <id> to stop one");
+            ImGui::EndTooltip();
+        }
+    }
+
     ImGui::Separator();
 
     // Options menu
@@ -484,9 +542,32 @@ inline void IMGUIQuakeConsole::render(const char *title, bool& p_open)
 
     ImGui::PopStyleVar();
     ImGui::EndChild();
+
+    renderCompletionPopup();
+
     ImGui::Separator();
 
-    if (is.render())
+    // a candidate was clicked, so give the input line its focus back to take it
+    if (popup.accept >= 0)
+    {
+        ImGui::SetKeyboardFocusHere();
+    }
+
+    const bool entered = is.render();
+
+    // ImGui 1.87 takes ImGuiKey values directly; before that keys go through the backend's key map
+#if IMGUI_VERSION_NUM >= 18700
+    const bool escape = ImGui::IsKeyPressed(ImGuiKey_Escape);
+#else
+    const bool escape = ImGui::IsKeyPressed(ImGui::GetKeyIndex(ImGuiKey_Escape));
+#endif
+
+    if (popup.open && (entered || escape || (!ImGui::IsItemActive() && !popup.hovered && popup.accept < 0)))
+    {
+        popup.open = false;
+    }
+
+    if (entered)
     {
         HistoryPos = -1;
 
@@ -506,6 +587,20 @@ inline void IMGUIQuakeConsole::render(const char *title, bool& p_open)
 
 inline void IMGUIQuakeConsole::historyCallback(ImGuiInputTextCallbackData *data)
 {
+    // the arrow keys move through the completion popup while it's open
+    if (popup.open && completion.candidates.size())
+    {
+        const std::size_t count = completion.candidates.size();
+
+        if (data->EventKey == ImGuiKey_UpArrow)
+            popup.selected = (popup.selected + count - 1) % count;
+        else if (data->EventKey == ImGuiKey_DownArrow)
+            popup.selected = (popup.selected + 1) % count;
+
+        popup.scrollToSelected = true;
+        return;
+    }
+
     // Example of HISTORY
     const int prev_history_pos = HistoryPos;
     if (data->EventKey == ImGuiKey_UpArrow)
@@ -518,7 +613,7 @@ inline void IMGUIQuakeConsole::historyCallback(ImGuiInputTextCallbackData *data)
     else if (data->EventKey == ImGuiKey_DownArrow)
     {
         if (HistoryPos != -1)
-            if (++HistoryPos >= con.historyBuffer().size())
+            if (++HistoryPos >= int(con.historyBuffer().size()))
                 HistoryPos = -1;
     }
 
@@ -533,84 +628,191 @@ inline void IMGUIQuakeConsole::historyCallback(ImGuiInputTextCallbackData *data)
 
 inline void IMGUIQuakeConsole::textCompletionCallback(ImGuiInputTextCallbackData *data)
 {
-    // Locate beginning of current word
-    const char *word_end = data->Buf + data->CursorPos;
-    const char *word_start = word_end;
-    while (word_start > data->Buf)
+    // Tab again takes the candidate picked in the popup
+    if (popup.open && completion.candidates.size())
     {
-        const char c = word_start[-1];
-        if (c == ' ' || c == '\t' || c == ',' || c == ';')
-            break;
-        word_start--;
+        if (data->CursorPos != (int)completion.wordEnd)
+        {
+            refreshCompletion(data);
+        }
+
+        if (completion.candidates.size())
+        {
+            acceptCompletion(data, std::min(popup.selected, completion.candidates.size() - 1));
+        }
+
+        return;
     }
 
-    // Build a list of candidates
-    ImVector<std::string> candidates;
+    // Let the console work out which word the cursor is in, and what could go there : names for the command, or whatever
+    // the command's completion provider offers for its arguments
+    refreshCompletion(data);
 
-    // autocomplete commands...
-    for (auto it = con.getCommandTable().begin(); it != con.getCommandTable().end(); it++)
+    if (completion.candidates.size() == 1 && !completion.fuzzy && !completion.pending)
     {
-        if (Strnicmp(it->first.c_str(), word_start, (int)(word_end - word_start)) == 0)
-        {
-            candidates.push_back(it->first);
-        }
+        // Single match. Delete the beginning of the word and replace it entirely so we've got nice casing.
+        acceptCompletion(data, 0);
+        return;
     }
 
-    // ... and autcomplete variables
-    for (auto it = con.getCVarReadTable().begin(); it != con.getCVarReadTable().end(); it++)
+    if (completion.candidates.size() && !completion.fuzzy && completion.commonLength > 0)
     {
-        if (Strnicmp(it->first.c_str(), word_start, (int)(word_end - word_start)) == 0)
+        // Multiple matches. Complete as much as we can..
+        // So inputing "C"+Tab will complete to "CL" then show "CLEAR" and "CLASSIFY" in the popup.
+        const std::string &candidate = completion.candidates[0];
+        data->DeleteChars((int)completion.wordBegin, (int)(completion.wordEnd - completion.wordBegin));
+        data->InsertChars((int)completion.wordBegin, candidate.data(), candidate.data() + completion.commonLength);
+        completion.wordEnd = completion.wordBegin + completion.commonLength;
+    }
+
+    // the popup also says when there's no match, or the candidates are still being gathered
+    popup.open = true;
+    popup.selected = 0;
+    popup.scrollToSelected = true;
+}
+
+inline void IMGUIQuakeConsole::textEditCallback(ImGuiInputTextCallbackData *data)
+{
+    if (!popup.open)
+        return;
+
+    refreshCompletion(data);
+
+    popup.selected = 0;
+    popup.scrollToSelected = true;
+
+    if (completion.candidates.empty() && !completion.pending)
+    {
+        popup.open = false;
+    }
+}
+
+inline void IMGUIQuakeConsole::textAlwaysCallback(ImGuiInputTextCallbackData *data)
+{
+    if (popup.accept >= 0)
+    {
+        const std::size_t index = (std::size_t)popup.accept;
+        popup.accept = -1;
+
+        if (index < completion.candidates.size())
         {
-            candidates.push_back(it->first);
+            acceptCompletion(data, index);
         }
     }
+    else if (popup.open && completion.pending)
+    {
+        refreshCompletion(data);
+    }
+}
+
+inline void IMGUIQuakeConsole::refreshCompletion(ImGuiInputTextCallbackData *data)
+{
+    con.complete(std::string_view(data->Buf, data->BufTextLen), data->CursorPos, completion);
+}
 
-    if (candidates.Size == 0)
+inline void IMGUIQuakeConsole::acceptCompletion(ImGuiInputTextCallbackData *data, std::size_t index)
+{
+    popup.open = false;
+
+    if (completion.wordEnd > (std::size_t)data->BufTextLen)
+        return;
+
+    const std::string candidate = completion.candidates[index];
+    const bool directory = candidate.size() && candidate.back() == '/';
+
+    data->DeleteChars((int)completion.wordBegin, (int)(completion.wordEnd - completion.wordBegin));
+    data->InsertChars((int)completion.wordBegin, candidate.data(), candidate.data() + candidate.size());
+
+    // Directories get descended into rather than finished off
+    if (!directory)
+        data->InsertChars((int)(completion.wordBegin + candidate.size()), " ");
+
+    data->CursorPos = (int)(completion.wordBegin + candidate.size() + (directory ? 0 : 1));
+    data->SelectionStart = data->SelectionEnd = data->CursorPos;
+
+    if (directory)
     {
-        // No match
-        //AddLog("No match for %.*s, , word_start);
-        (*this) << "No match for ";
-        (*this) << (int)(word_end - word_start);
-        (*this) << ' ' << word_start;
-        (*this) << "!\n";
+        // keep going with what's inside it
+        refreshCompletion(data);
+        popup.open = completion.candidates.size() || completion.pending;
+        popup.selected = 0;
+        popup.scrollToSelected = true;
     }
-    else if (candidates.Size == 1)
+}
+
+inline void IMGUIQuakeConsole::renderCompletionPopup()
+{
+    popup.hovered = false;
+
+    if (!popup.open)
+        return;
+
+    const ImGuiStyle &style = ImGui::GetStyle();
+    const std::size_t count = completion.candidates.size();
+    const float rowHeight = ImGui::GetTextLineHeightWithSpacing();
+    const int rows = (int)std::min<std::size_t>(std::max<std::size_t>(count, 1), (std::size_t)std::max(completionRows, 1));
+    const float height = rows * rowHeight + style.WindowPadding.y * 2.0f;
+
+    // drawn over the bottom of the scrollback rather than pushing it up, so the output doesn't jump as the popup opens and closes
+    const float belowY = ImGui::GetCursorPosY();
+    ImGui::SetCursorPosY(belowY - style.ItemSpacing.y - height);
+
+    ImGui::BeginChild("##completions", ImVec2(0, height), true);
+    popup.hovered = ImGui::IsWindowHovered();
+
+    if (count == 0)
     {
-        // Single match. Delete the beginning of the word and replace it entirely so we've got nice casing.
-        data->DeleteChars((int)(word_start - data->Buf), (int)(word_end - word_start));
-        data->InsertChars(data->CursorPos, candidates[0].c_str());
-        data->InsertChars(data->CursorPos, " ");
+        ImGui::TextDisabled("%s", completion.pending ? "Looking for matches..." : "No match");
     }
     else
     {
-        // Multiple matches. Complete as much as we can..
-        // So inputing "C"+Tab will complete to "CL" then display "CLEAR" and "CLASSIFY" as matches.
-        int match_len = (int)(word_end - word_start);
-        for (;;)
+        if (popup.scrollToSelected)
         {
-            int c = 0;
-            bool all_candidates_matches = true;
-            for (int i = 0; i < candidates.Size && all_candidates_matches; i++)
-                if (i == 0)
-                    c = toupper(candidates[i][match_len]);
-                else if (c == 0 || c != toupper(candidates[i][match_len]))
-                    all_candidates_matches = false;
-            if (!all_candidates_matches)
-                break;
-            match_len++;
+            const float top = popup.selected * rowHeight;
+            const float visible = ImGui::GetWindowHeight() - style.WindowPadding.y * 2.0f;
+
+            if (top < ImGui::GetScrollY())
+                ImGui::SetScrollY(top);
+            else if (top + rowHeight > ImGui::GetScrollY() + visible)
+                ImGui::SetScrollY(top + rowHeight - visible);
+
+            popup.scrollToSelected = false;
         }
 
-        if (match_len > 0)
+        // only the rows in view are submitted, and only their help is looked up, however many candidates there are
+        ImGuiListClipper clipper;
+        clipper.Begin((int)count, rowHeight);
+
+        while (clipper.Step())
         {
-            data->DeleteChars((int)(word_start - data->Buf), (int)(word_end - word_start));
-            data->InsertChars(data->CursorPos, candidates[0].c_str(), candidates[0].c_str() + match_len);
-        }
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
+            {
+                const std::string &candidate = completion.candidates[i];
 
-        // List matches
-        (*this) << "Possible matches:\n";
-        for (int i = 0; i < candidates.Size; i++)
-            (*this) << "- " << candidates[i] << '\n';
+                ImGui::PushID(i);
+                if (ImGui::Selectable(candidate.c_str(), (std::size_t)i == popup.selected))
+                {
+                    popup.selected = (std::size_t)i;
+                    popup.accept = i;
+                }
+                ImGui::PopID();
+
+                // the first line of the help, fetched from its provider the first time it scrolls into view
+                const std::string_view help = con.helpText(candidate);
+
+                if (help.size())
+                {
+                    const std::size_t length = std::min(help.find('\n'), std::min(help.size(), (std::size_t)std::max(completionHelpLength, 0)));
+
+                    ImGui::SameLine();
+                    ImGui::TextDisabled("%.*s", (int)length, help.data());
+                }
+            }
+        }
     }
+
+    ImGui::EndChild();
+    ImGui::SetCursorPosY(belowY);
 }
 
 inline ImU32 getANSIBackgroundColor(AnsiColorCode code)
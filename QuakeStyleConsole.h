@@ -23,6 +23,10 @@
  -- echo : eg. echo health - prints the value of the variable to the console
  -- set : eg. set health 25 - sets the value of a variable in the console
  -- runFile <filename> - execute all the commands in a file as if the user typed them in sequence.
+ -- wait <frames> - in a script, pauses the rest of the script for a number of frames (default 1).  The host advances frames with tick()
+ -- sleep <ms> - in a script, pauses the rest of the script for a number of milliseconds
+ -- jobs - lists the async commands running in the background.  jobs cancel <id> stops one
+ -- alias <name> "<cmd1>; <cmd2>" - makes name a command that runs the commands in order.  alias alone lists the aliases, unalias <name> removes one
  
  --$: Strings prefixed with $ are interpreted as variable names to dereference, and the identifiers will be replaced in the input with the variable value - eg.
  var x listCmd
@@ -40,692 +44,6248 @@
 #include <iostream>
 #include <fstream>
 #include <unordered_map>
+#include <algorithm>
 #include <deque>
 #include <functional>
 #include <sstream>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
+#include <cctype>
+#include <limits>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <atomic>
+#include <charconv>
+#include <cstdlib>
+#include <type_traits>
+#include <array>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <optional>
+#include <chrono>
+#include <iterator>
+#include <filesystem>
+#include <exception>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// coroutine commands need C++20
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#include <coroutine>
+#define VIRTUOSO_CONSOLE_COROUTINES
+#endif
+#endif
+
+// OS headers for memory mapping files.  On Windows this brings in <windows.h> for everyone including this header;
+// the lean/no min max macros are only defined around it and undone afterwards.  Define VIRTUOSO_CONSOLE_NO_MMAP to
+// leave the OS headers out entirely, and files are read into memory instead
+#if defined(VIRTUOSO_CONSOLE_NO_MMAP)
+#elif defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#define VIRTUOSO_CONSOLE_UNDEF_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#define VIRTUOSO_CONSOLE_UNDEF_NOMINMAX
+#endif
+#include <windows.h>
+#ifdef VIRTUOSO_CONSOLE_UNDEF_LEAN_AND_MEAN
+#undef WIN32_LEAN_AND_MEAN
+#undef VIRTUOSO_CONSOLE_UNDEF_LEAN_AND_MEAN
+#endif
+#ifdef VIRTUOSO_CONSOLE_UNDEF_NOMINMAX
+#undef NOMINMAX
+#undef VIRTUOSO_CONSOLE_UNDEF_NOMINMAX
+#endif
+#define VIRTUOSO_CONSOLE_WIN32_MMAP
+#elif defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define VIRTUOSO_CONSOLE_POSIX_MMAP
+#endif
 
 namespace Virtuoso
 {
 
-class QuakeStyleConsole
+// -----------------------------------------------------------------------------
+// Argument parsing helpers
+// Command lines are tokenized once into string_views.  Commands receive a ConsoleArgs cursor over those tokens
+// and istream based parsers read the remaining text through a ViewIStream, so nothing is copied into a stringstream.
+// -----------------------------------------------------------------------------
+
+/// whitespace test that is safe for negative chars
+inline bool isConsoleSpace(char c) { return std::isspace(static_cast<unsigned char>(c)) != 0; }
+
+/// read only streambuf over a range of characters it does not own
+class ViewStreamBuf : public std::streambuf
 {
-  public:                                               // the methods in this section are what you should use in your code
-    static const unsigned int defaultHistorySize = 10u; ///size of the history file
+  public:
+    ViewStreamBuf(std::string_view view = std::string_view());
 
-    typedef std::function<void(std::istream &is, std::ostream &os)> ConsoleFunc;
+    /// number of characters read from the view so far
+    std::size_t consumed() const { return static_cast<std::size_t>(gptr() - eback()); }
 
-    typedef std::unordered_map<std::string, ConsoleFunc> CommandTable;
-    typedef std::unordered_map<std::string, ConsoleFunc> CVarReadTable;
-    typedef std::unordered_map<std::string, ConsoleFunc> CVarPrintTable;
-    typedef std::unordered_map<std::string, std::string> HelpTable;
+  protected:
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+};
 
-    /// Constructor binds the default commands to the command table & initializes history buffer
-    QuakeStyleConsole(std::size_t maxHistory = defaultHistorySize);
+/// istream over a string_view.  Used to hand text to operator >> without copying it into a stringstream
+class ViewIStream : public std::istream
+{
+    ViewStreamBuf buf;
 
-    // --------------------------------------//
-    /* --------- COMMAND EXECUTION --------- */
-    // --------------------------------------//
-    // call one of these functions to make the console do things - eg. the first one when you press enter
-    // and your GUI console widget gives you a string
-    // You can execute all commands in an input stream until EOF with executeUntilEOF(),
-    // or run every line in a file (eg. a startup or debug playback file) with executeFile()
+  public:
+    ViewIStream(std::string_view view) : std::istream(nullptr), buf(view) { rdbuf(&buf); }
 
-    /// Execute command line passed in as string.  Console output goes to "output"
-    void commandExecute(const std::string &str, std::ostream &output);
+    std::size_t consumed() const { return buf.consumed(); }
+};
 
-    /// Get a command line from the input stream and execute it.   Console output goes to "output"
-    void commandExecute(std::istream &input, std::ostream &output);
+/// streambuf that appends everything written to it onto a std::string
+class StringAppendBuf : public std::streambuf
+{
+    std::string &str;
 
-    /// execute commands from an istream until EOF
-    void executeUntilEOF(std::istream &f, std::ostream &output);
+  public:
+    StringAppendBuf(std::string &s) : str(s) {}
 
-    /// execute commands from a file (named by the input string 'f') until EOF
-    void executeFile(const std::string &f, std::ostream &output);
+  protected:
+    int_type overflow(int_type c) override;
+    std::streamsize xsputn(const char *s, std::streamsize n) override;
+};
 
-    //------------------------------------//
-    /*----------- ADDING CVARS -----------*/
-    //-------------------------------------//
-    // Call one of these to add variables (eg, Player.health) from your c++ code to the console.
-    // This makes them available to built in commands using the given "varname" - dereference them with $, print them with echo, and set them with "set"
+/// A read only memory mapping of a whole file, for running scripts without copying them.
+/// Only regular files are mapped; open() fails for pipes, devices and missing files, and callers fall back to streaming.
+/// Without a mapping for the platform (or with VIRTUOSO_CONSOLE_NO_MMAP), regular files are read into a buffer instead.
+class MappedFile
+{
+    const char *data = nullptr;
+    std::size_t length = 0;
+    bool opened = false;
+#if !defined(VIRTUOSO_CONSOLE_WIN32_MMAP) && !defined(VIRTUOSO_CONSOLE_POSIX_MMAP)
+    std::string contents; ///< the file, read in whole when it can't be mapped
+#endif
 
-    /// function which takes in a string and a variable from client code we want to associate with it in the console.  Takes in an optional help string to describe the variable to the user.
-    template <class T>
-    void bindCVar(const std::string &varname, T &var, const std::string &help = "");
+  public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string &path) { open(path); }
+    ~MappedFile() { close(); }
 
-    // ------------------------------------//
-    /* --------- ADDING COMMANDS ----------*/
-    // ------------------------------------//
-    // You should call console.bindCommand() with the command name you want and a C++ function from your code with an arbitrary signature.  Optionally provide a help string for the command as a third argument
-    // You shouldn't need to worry about which overload or template arguments to use - it should resolve automatically.
-    // If your function has arguments, so long as there is an istream operator to read them from the input,
-    // the console will automatically parse them with variadic template and lambda magic, so you never have to write a parser
-    // IF YOU ARE USING A MEMBER FUNCTION - we need to wrap the "this" pointer too, so call bindMemberCommand() which takes the object reference as the first argument after the command name
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
 
-    /// add a command to the console using a function pointer that takes no arguments.  set the associated help string to the "help" argument
-    void bindCommand(const std::string &commandName, void (*fptr)(void), const std::string &help = "");
+    /// maps the file named by path, unmapping any previous file.  Returns false if it can't be read or isn't a regular file
+    bool open(const std::string &path);
 
-    ///add a command to the console using a function pointer that takes arbitrary arguments, then set the associated help string to the "help" argument
-    template <typename... Args>
-    void bindCommand(const std::string &commandName, void (*fptr)(Args...), const std::string &help = "");
+    /// unmaps the file
+    void close();
 
-    ///add a command to the console using a function object with arbitrary arguments, then set the associated help string to the optional "help" argument
-    template <typename... Args>
-    void bindCommand(const std::string &commandName, std::function<void(Args...)> fun, const std::string &help = "");
+    bool isOpen() const { return opened; }
 
-    /// same as bindCommand, but for a member function of an object.  Object instance is first argument after the command name
-    template <typename O, typename... Args>
-    void bindMemberCommand(const std::string &commandName, O &obj, void (O::*fptr)(Args...), const std::string &help = "");
+    /// the contents of the file.  Valid until close()
+    std::string_view view() const { return std::string_view(data, length); }
+};
 
-    /// the bindCommand that actually does the work of adding commands to the table AFTER they've been coerced to a ConsoleFunc that takes the input/output from executeCommand.  Takes optional help string.
-    void bindCommand(const std::string &commandName, ConsoleFunc f, const std::string &help = "");
+/// Cursor over the tokens of a command line.  This is what commands receive as their input.
+/// Tokens are views into the console's line buffer and are only valid for the duration of the command.
+class ConsoleArgs
+{
+  public:
+    ConsoleArgs() {}
+    ConsoleArgs(std::string_view line, const std::string_view *tokens, std::size_t count) : text(line), tokens(tokens), count(count) {}
 
-    // ------------------------------------//
-    /* --------- HISTORY FILES ----------- */
-    // ------------------------------------//
-    /* Saving and loading the history buffer of previously executed commands to file  */
+    bool empty() const { return pos >= count; }
+    std::size_t remaining() const { return count - pos; }
 
-    /// populate the command buffer from an input file named by string inFile
-    bool loadHistoryBuffer(const std::string &inFile);
+    /// returns the next token without consuming it, or an empty view if there are none left
+    std::string_view peek() const { return empty() ? std::string_view() : tokens[pos]; }
 
-    /// write the history buffer to file named by string outFile
-    void saveHistoryBuffer(const std::string &outFile);
+    /// consumes and returns the next token, or an empty view if there are none left
+    std::string_view next() { return empty() ? std::string_view() : tokens[pos++]; }
 
-    /// populate the command buffer from an input file named by istream inFile
-    void loadHistoryBuffer(std::istream &inFile);
+    /// consumes the next token into tok.  returns false if there are none left
+    bool next(std::string_view &tok);
 
-    /// write the history buffer to file named by ostream outFile
-    void saveHistoryBuffer(std::ofstream &outfile);
+    /// the unconsumed remainder of the line, starting at the next token
+    std::string_view rest() const;
 
-    // ------------------------------------//
-    /* ----------OUTPUT STYLING------------*/
-    // ------------------------------------//
+    /// skip every token that begins within the first n characters of rest()
+    void consume(std::size_t n);
 
-    /// begin / end pairs that wrap output of a certain type
-    struct ConsoleStyling
+    /// skip the remainder of the line
+    void skipAll() { pos = count; }
+
+    /// runs an istream based parser f(std::istream&) over rest(), then skips whatever it read.  returns false if the stream failed
+    template <class F>
+    bool parseStream(F &&f);
+
+  private:
+    std::string_view text;
+    const std::string_view *tokens = nullptr;
+    std::size_t count = 0;
+    std::size_t pos = 0;
+};
+
+// -----------------------------------------------------------------------------
+// ConsoleArgParser
+// Customization point for reading a value of type T from the front of a command's arguments.
+// Used for the arguments of bound functions and for setting cvars.
+// parse() consumes what it reads and returns false on a syntax error, leaving the arguments where they were.
+// Numbers go through std::from_chars, bools accept on/off/true/false/1/0, strings may be "quoted".
+// Everything else falls back to operator >> over the rest of the line, so specialize this for your own types if that matters.
+// -----------------------------------------------------------------------------
+
+template <class T, class Enable = void>
+struct ConsoleArgParser
+{
+    static bool parse(ConsoleArgs &args, T &value)
     {
-        std::pair<std::string, std::string> error;
-        std::pair<std::string, std::string> warning;
-        std::pair<std::string, std::string> echo;
-    };
+        return args.parseStream([&value](std::istream &is) { is >> value; });
+    }
+};
 
-    /// ANSI color codes wrap the output in the scope.
-    inline static ConsoleStyling ConsoleStylingColor() { return {{"\u001b[37;41;1m[error]: ", "\u001b[0m"}, {"\u001b[33;1m[warning]: ", "\u001b[0m"}, {"\u001b[32;1m> ", "\u001b[0m"}}; }
+/// true for the integer types we parse as numbers.  The character types keep reading a single character through operator >>
+template <class T>
+struct IsConsoleInteger : std::integral_constant<bool, std::is_integral<T>::value &&
+                                                           !std::is_same<T, bool>::value &&
+                                                           !std::is_same<T, char>::value &&
+                                                           !std::is_same<T, signed char>::value &&
+                                                           !std::is_same<T, unsigned char>::value>
+{
+};
 
-    /// Styling parameters with no colors, just tags
-    inline static ConsoleStyling ConsoleStylingPlain() { return {{"[error]: ", ""}, {"[warning]: ", ""}, {"> ", ""}}; }
+/// parses a whole token as a number.  Accepts a leading + like operator >> does
+template <class T>
+bool parseConsoleNumber(std::string_view token, T &value);
 
-    ConsoleStyling style = ConsoleStylingPlain(); ///< public so user can modify.  Initialized using uncolored output
+template <class T>
+struct ConsoleArgParser<T, typename std::enable_if<IsConsoleInteger<T>::value || std::is_floating_point<T>::value>::type>
+{
+    static bool parse(ConsoleArgs &args, T &value);
+};
 
-    // - sugared getters for console implementation -
+/// the words that read as a bool
+struct ConsoleBoolName
+{
+    std::string_view name;
+    bool value;
+};
 
-    const std::pair<std::string, std::string> &error() { return style.error; }
-    const std::pair<std::string, std::string> &warning() { return style.warning; }
-    const std::pair<std::string, std::string> &echo() { return style.echo; }
+inline constexpr ConsoleBoolName consoleBoolNames[] = {{"1", true}, {"0", false}, {"on", true}, {"off", false}, {"true", true}, {"false", false}};
 
-    // ------------------------------------//
-    /* ----OTHER GETTERS AND SETTERS-------*/
-    // ------------------------------------//
+template <>
+struct ConsoleArgParser<bool>
+{
+    static bool parse(ConsoleArgs &args, bool &value);
+};
 
-    /// sets the help string (see built in 'help' command) for a given topic
-    void setHelpTopic(const std::string &topic, const std::string &data);
+/// strips the quotes from a "quoted" token
+inline std::string_view unquoteToken(std::string_view token);
 
-    const std::deque<std::string> &historyBuffer() const;
-    inline const CommandTable &getCommandTable() const { return commandTable; }
-    inline const CVarReadTable &getCVarReadTable() const { return cvarReadFTable; }
-    inline const CVarPrintTable &getCVarPrintTable() const { return cvarPrintFTable; }
-    inline const HelpTable &getHelpTable() const { return helpTable; }
+template <>
+struct ConsoleArgParser<std::string>
+{
+    static bool parse(ConsoleArgs &args, std::string &value);
+};
 
-  protected:
-    /// WindowedQueue - We implement a ring buffer for the command history as a queue
-    template <class T>
-    class WindowedQueue : public std::deque<T>
+/// views stay valid until the command returns
+template <>
+struct ConsoleArgParser<std::string_view>
+{
+    static bool parse(ConsoleArgs &args, std::string_view &value);
+};
+
+// -----------------------------------------------------------------------------
+// AllocationProbe
+// Counts calls to global operator new, so tests and benchmarks can check that a code path doesn't allocate.
+// To install it, #define VIRTUOSO_CONSOLE_ALLOCATION_PROBE_IMPLEMENTATION in exactly one translation unit before including this file.
+// The replacement operator new is only compiled into debug builds (NDEBUG not defined); otherwise installed stays false.
+// -----------------------------------------------------------------------------
+struct AllocationProbe
+{
+    /// called on every allocation, after it is counted, with the requested size
+    typedef void (*Hook)(std::size_t bytes);
+
+    inline static std::atomic<std::size_t> allocations{0}; ///< total allocations since program start
+    inline static std::atomic<Hook> hook{nullptr};         ///< optional user hook, eg. to break in a debugger
+    inline static bool installed = false;                  ///< true if the replacement operator new is linked in
+
+    static void record(std::size_t bytes)
     {
-        void fix_size()
+        allocations.fetch_add(1, std::memory_order_relaxed);
+
+        if (Hook h = hook.load(std::memory_order_relaxed))
         {
-            while (std::deque<T>::size() > m_capacity)
-            {
-                std::deque<T>::pop_front();
-            }
+            h(bytes);
         }
+    }
+};
 
-        std::size_t m_capacity;
+/// counts the allocations made during its lifetime
+class AllocationScope
+{
+    std::size_t start;
 
-      public:
-        WindowedQueue(std::size_t maxCapacity) : m_capacity(maxCapacity)
+  public:
+    AllocationScope() : start(AllocationProbe::allocations.load(std::memory_order_relaxed)) {}
+
+    std::size_t count() const { return AllocationProbe::allocations.load(std::memory_order_relaxed) - start; }
+};
+
+/// A callable stored in a fixed buffer inside the object, like a std::function that never allocates.
+/// Used for the console's command and cvar tables, whose callables only ever capture a few pointers.
+/// A callable larger than Capacity (eg. one capturing a std::function, which is 64 bytes on MSVC) is kept on the heap instead.
+template <class Signature, std::size_t Capacity = 48>
+class InplaceFunction;
+
+template <class R, class... Args, std::size_t Capacity>
+class InplaceFunction<R(Args...), Capacity>
+{
+    /// type erased operations for the stored callable
+    struct Ops
+    {
+        R (*invoke)(void *f, Args &&... args);
+        void (*copy)(void *dst, const void *src);
+        void (*move)(void *dst, void *src);
+        void (*destroy)(void *f);
+    };
+
+    template <class F>
+    static R call(F &f, Args &&... args)
+    {
+        if constexpr (std::is_void<R>::value)
         {
+            f(std::forward<Args>(args)...); // a void signature discards the result, eg. a ConsoleTask
         }
-
-        void capacity(std::size_t newCapacity)
+        else
         {
-            m_capacity = newCapacity;
-            fix_size();
+            return f(std::forward<Args>(args)...);
         }
+    }
 
-        std::size_t capacity() const
+    /// whether F is stored in the buffer; anything else is stored as a pointer to a heap copy
+    template <class F>
+    static constexpr bool fitsInplace = sizeof(F) <= Capacity && alignof(F) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible<F>::value;
+
+    template <class F>
+    struct OpsFor
+    {
+        static R invoke(void *f, Args &&... args) { return call(*static_cast<F *>(f), std::forward<Args>(args)...); }
+        static void copy(void *dst, const void *src) { ::new (dst) F(*static_cast<const F *>(src)); }
+        static void move(void *dst, void *src) { ::new (dst) F(std::move(*static_cast<F *>(src))); }
+        static void destroy(void *f) { static_cast<F *>(f)->~F(); }
+
+        static constexpr Ops ops = {&invoke, &copy, &move, &destroy};
+    };
+
+    template <class F>
+    struct HeapOpsFor
+    {
+        static R invoke(void *f, Args &&... args) { return call(**static_cast<F **>(f), std::forward<Args>(args)...); }
+        static void copy(void *dst, const void *src) { *static_cast<F **>(dst) = new F(**static_cast<F *const *>(src)); }
+        static void move(void *dst, void *src) { *static_cast<F **>(dst) = std::exchange(*static_cast<F **>(src), nullptr); }
+        static void destroy(void *f) { delete *static_cast<F **>(f); }
+
+        static constexpr Ops ops = {&invoke, &copy, &move, &destroy};
+    };
+
+    template <class F>
+    using EnableIfCallable = typename std::enable_if<!std::is_same<typename std::decay<F>::type, InplaceFunction>::value &&
+                                                     (std::is_void<R>::value ||
+                                                      std::is_convertible<decltype(std::declval<typename std::decay<F>::type &>()(std::declval<Args>()...)), R>::value)>::type;
+
+    alignas(std::max_align_t) unsigned char storage[Capacity];
+    const Ops *ops = nullptr;
+
+  public:
+    InplaceFunction() = default;
+    InplaceFunction(std::nullptr_t) {}
+
+    template <class F, class = EnableIfCallable<F>>
+    InplaceFunction(F &&f)
+    {
+        typedef typename std::decay<F>::type Stored;
+
+        if constexpr (fitsInplace<Stored>)
         {
-            return m_capacity;
+            ::new (static_cast<void *>(storage)) Stored(std::forward<F>(f));
+            ops = &OpsFor<Stored>::ops;
         }
-        using std::deque<T>::operator[];
-
-        template <class... Args>
-        void emplace(Args &&... args)
+        else
         {
-            std::deque<T>::emplace_back(std::forward<Args>(args)...);
-            fix_size();
+            *reinterpret_cast<Stored **>(storage) = new Stored(std::forward<F>(f));
+            ops = &HeapOpsFor<Stored>::ops;
         }
+    }
 
-        void push(const T &value)
+    /// whether a callable of type F is kept in the buffer rather than on the heap
+    template <class F>
+    static constexpr bool storedInplace() { return fitsInplace<typename std::decay<F>::type>; }
+
+    InplaceFunction(const InplaceFunction &other) : ops(other.ops)
+    {
+        if (ops)
+            ops->copy(storage, other.storage);
+    }
+
+    InplaceFunction(InplaceFunction &&other) : ops(other.ops)
+    {
+        if (ops)
+            ops->move(storage, other.storage);
+    }
+
+    ~InplaceFunction() { reset(); }
+
+    InplaceFunction &operator=(const InplaceFunction &other)
+    {
+        if (this != &other)
         {
-            std::deque<T>::push_back(value);
-            fix_size();
+            reset();
+            if (other.ops)
+                other.ops->copy(storage, other.storage);
+            ops = other.ops;
         }
+        return *this;
+    }
 
-        void push(T &&value)
+    InplaceFunction &operator=(InplaceFunction &&other)
+    {
+        if (this != &other)
         {
-            std::deque<T>::push_back(value);
-            fix_size();
+            reset();
+            if (other.ops)
+                other.ops->move(storage, other.storage);
+            ops = other.ops;
         }
-        void pop()
+        return *this;
+    }
+
+    InplaceFunction &operator=(std::nullptr_t)
+    {
+        reset();
+        return *this;
+    }
+
+    /// destroys the stored callable, leaving this empty
+    void reset()
+    {
+        if (ops)
         {
-            std::deque<T>::pop_front();
+            ops->destroy(storage);
+            ops = nullptr;
         }
+    }
+
+    explicit operator bool() const { return ops != nullptr; }
+
+    R operator()(Args... args) const { return ops->invoke(const_cast<unsigned char *>(storage), std::forward<Args>(args)...); }
+};
+
+/// storage type of a cvar.  Native types are read and written through a typed pointer; anything else goes through closures
+enum CVarType : std::uint8_t
+{
+    CVAR_NONE,   ///< not a cvar
+    CVAR_CUSTOM, ///< arbitrary type, parsed and printed through closures
+    CVAR_INT,
+    CVAR_FLOAT,
+    CVAR_DOUBLE,
+    CVAR_BOOL,
+    CVAR_STRING
+};
+
+/// maps a C++ type to its CVarType
+template <class T> struct CVarTypeOf { static constexpr CVarType value = CVAR_CUSTOM; };
+template <> struct CVarTypeOf<int> { static constexpr CVarType value = CVAR_INT; };
+template <> struct CVarTypeOf<float> { static constexpr CVarType value = CVAR_FLOAT; };
+template <> struct CVarTypeOf<double> { static constexpr CVarType value = CVAR_DOUBLE; };
+template <> struct CVarTypeOf<bool> { static constexpr CVarType value = CVAR_BOOL; };
+template <> struct CVarTypeOf<std::string> { static constexpr CVarType value = CVAR_STRING; };
+
+/// Bounded lock free queue for many producer threads and one consumer thread.  A ring of cells, each with a sequence number
+/// that says whether it is ready to be written or read, after Dmitry Vyukov's bounded MPMC queue.  push never blocks; it fails when the queue is full.
+template <class T>
+class BoundedMPSCQueue
+{
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence;
+        T value;
     };
 
-    typedef WindowedQueue<std::string> ConsoleHistoryBuffer;
+    std::unique_ptr<Cell[]> cells;
+    std::size_t mask;
 
-    ConsoleHistoryBuffer history_buffer; ///< history buffer of previous commands
+    alignas(64) std::atomic<std::size_t> enqueuePos{0}; ///< shared by the producers
+    alignas(64) std::size_t dequeuePos = 0;             ///< only touched by the consumer
 
-    /// maps strings naming cVars to functions which read them from a std::istream.
-    /// This allows the console to parse variables of any type representable as text without modifying the console code or adding custom parsing code.
-    CVarReadTable cvarReadFTable;
+  public:
+    /// capacity is rounded up to a power of two
+    explicit BoundedMPSCQueue(std::size_t capacity);
 
-    /// maps strings naming cVars to functions which write the variables of arbitrary type out to a std::ostream
-    CVarPrintTable cvarPrintFTable;
+    BoundedMPSCQueue(const BoundedMPSCQueue &) = delete;
+    BoundedMPSCQueue &operator=(const BoundedMPSCQueue &) = delete;
 
-    ///maps strings to std function objects, representing the available commands to the user.  eg, quit, set, etc
-    CommandTable commandTable;
+    /// adds value to the queue.  Safe from any thread.  Returns false, leaving value alone, if the queue is full
+    bool push(T &&value);
 
-    /// maps names of functions or cvars to string literals containing helpful information on their use
-    HelpTable helpTable;
+    /// takes the oldest value from the queue.  Consumer thread only.  Returns false if the queue is empty
+    bool pop(T &value);
 
-    ///function which simply sets the value of an arbitrary type based on what's in the input stream
-    ///the arguments are "eaten" by std bind, allowing it to be stored as type void (*x)(void) in the cvarReadFTable
-    template <class T>
-    void setCvar(std::istream &is, std::ostream &os, T *var);
+    std::size_t capacity() const { return mask + 1; }
+};
 
-    ///function which simply prints the value of a variable to an output stream
-    ///the arguments are "eaten" by std bind, allowing it to be stored as type void (*x)(void) in the cvarPrintFTable
-    template <class T>
-    void printCvar(std::ostream &os, T *var);
+/// A command running on the console's worker threads.  See QuakeStyleConsole::bindAsyncCommand()
+/// The body writes to out(), which is handed to the console a line at a time and printed by the owning thread's tick().
+/// Cancelling is cooperative : a long running body should check cancelled() and return early.
+class ConsoleJob
+{
+  public:
+    enum State : std::uint8_t
+    {
+        JOB_QUEUED,
+        JOB_RUNNING,
+        JOB_DONE,
+        JOB_CANCELLED
+    };
 
-    ///dumps a list of available commands to the output stream
-    void listCmd(std::ostream &os) const;
+    ConsoleJob(unsigned id, std::string name, std::function<void(ConsoleJob &)> body);
 
-    ///dumps a list of bound cvars to the output stream
-    void listCVars(std::ostream &os) const;
+    ConsoleJob(const ConsoleJob &) = delete;
+    ConsoleJob &operator=(const ConsoleJob &) = delete;
 
-    ///dumps a list of available help topics to the output stream
-    void listHelp(std::ostream &os) const;
+    /// stream for the job's output.  Only the job's body should write to it
+    std::ostream &out() { return stream; }
 
-    ///The function associated with the built in command "set" which parses the name of a cvar, and if it is bound, sets the value based on
-    ///the value in the input stream
-    void commandSet(std::istream &is, std::ostream &os);
+    bool cancelled() const { return cancelRequested.load(std::memory_order_relaxed); }
 
-    ///the function associated with built in command "echo", which prints the value of a cvar if it is bound. if not, reports an error.
-    void commandEcho(std::istream &is, std::ostream &os);
+    /// asks the job to stop.  A queued job won't start
+    void cancel() { cancelRequested.store(true, std::memory_order_relaxed); }
 
-    ///prints help on a topic if the user types help < topic >, or a generic help message if the user just types help
-    void commandHelp(std::istream &, std::ostream &);
+    unsigned id() const { return jobId; }
+    const std::string &name() const { return jobName; }
+    State state() const { return jobState.load(std::memory_order_acquire); }
 
-    ///creates a string variable from the console
-    void commandVar();
+    /// seconds the job has been running, or ran for.  0 while it's queued
+    double seconds() const;
 
-    ///wrapper function which parses arguments to a function object of arbitrary type from the console's input stream then executes the function if the parsing was successful
-    template <typename... Args>
-    void parse(std::istream &is, std::ostream &os, std::function<void(Args...)> f);
+    /// appends the output written since the last call to text.  Returns false if there was none.  Safe from any thread
+    bool takeOutput(std::string &text);
 
-    ///This function is called by populateAndExecute, and only executes the bound function if the parsing succeeds
-    ///if parsing failed we do not want to pass in uninitialized garbage to the c++ function we bound
-    template <typename... Args>
-    void conditionalExecute(std::istream &is, std::ostream &os, std::function<void(Args...)> f, const Args &... args);
+    /// runs the body on the calling thread, unless the job was cancelled first
+    void run();
 
-    /// adds the built-in commands to the command table
-    void bindBasicCommands();
+  private:
+    /// buffers the body's output and passes it to the channel when a line ends or the buffer fills.  There's no put area,
+    /// so every write comes through overflow or xsputn, where the newlines are seen
+    class ChannelBuf : public std::streambuf
+    {
+        ConsoleJob &job;
+        char buffer[1024];
+        std::size_t used = 0;
 
-    /// helper function to return a default-constructed temp variable of a particular type.  Used in parsing arguments for C++ functions bound to the console
-    template <class T>
-    T makeTemp();
+      protected:
+        int overflow(int c) override;
+        std::streamsize xsputn(const char *s, std::streamsize n) override;
+        int sync() override;
 
-    /// for parsing arguments to C++ functions bound to the console.  variadic template that recursively parses our function arguments in order
-    template <typename FirstType, typename... Args>
-    void populateTemps(std::istream &is, FirstType &in, Args &... Temps);
+      public:
+        explicit ChannelBuf(ConsoleJob &j) : job(j) {}
+    };
 
-    /// for parsing arguments to C++ functions bound to the console. variadic template that recursively parses our function arguments in order.  base case
-    template <typename FirstType>
-    void populateTemps(std::istream &is, FirstType &in);
+    const unsigned jobId;
+    const std::string jobName;
+    std::function<void(ConsoleJob &)> body;
 
-    /// for parsing arguments to C++ functions bound to the console. variadic template that recursively parses our function arguments in order.  base case
-    void populateTemps(std::istream &is) {}
+    std::mutex channelMutex;
+    std::string channel; ///< output waiting for takeOutput()
 
-    /// for parsing arguments to C++ functions bound to the console.  call starts populating temp variables
-    template <typename... Args>
-    void goPopulateTemps(std::istream &is, Args &... temps);
+    std::atomic<State> jobState{JOB_QUEUED};
+    std::atomic<bool> cancelRequested{false};
+    std::atomic<std::int64_t> startTicks{0}; ///< steady_clock time the body started
+    std::atomic<std::int64_t> endTicks{0};   ///< and finished
 
-    /// for parsing arguments to C++ functions bound to the console.  Populates the temp variables using the istream, then calls the function with them
-    template <typename... Args>
-    void populateAndExecute(std::istream &is, std::ostream &os, std::function<void(Args...)> f,
-                            typename std::remove_const<typename std::remove_reference<Args>::type>::type... temps);
+    ChannelBuf buf;
+    std::ostream stream;
+};
+
+#ifdef VIRTUOSO_CONSOLE_COROUTINES
+/// Return type for console coroutines.  The coroutine runs as soon as it's called, and co_await console.nextFrame() or
+/// console.sleep() hands it to the console, which resumes it from tick().  It's fire and forget, so there's nothing to wait on.
+/// Take arguments by value : the caller's ConsoleArgs and stream are gone after the first co_await.  A coroutine must not throw.
+struct ConsoleTask
+{
+    struct promise_type
+    {
+        ConsoleTask get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+#endif
+
+class QuakeStyleConsole;
+
+/// A help string.  Whatever it's made from is copied, unless it's made with borrow(), which keeps a view of text known to outlive
+/// the console, like a literal, a static table or a mapped file.  See QuakeStyleConsole::setHelpTopic().
+class HelpText
+{
+  public:
+    HelpText() = default;
+
+    /// char arrays are copied too : a literal can't be told apart from a stack buffer that's gone by the time the help is read
+    template <std::size_t N>
+    HelpText(const char (&s)[N]) { assign(std::string_view(s, std::char_traits<char>::length(s))); }
+
+    HelpText(const std::string &s) { assign(s); }
+
+    /// char pointers are copied, since there's no telling what they point to
+    template <class P, typename std::enable_if<std::is_pointer<P>::value, int>::type = 0>
+    HelpText(const P &s) { assign(s ? std::string_view(s) : std::string_view()); }
+
+    HelpText(const HelpText &other) { *this = other; }
+    HelpText(HelpText &&other) = default;
+    HelpText &operator=(HelpText &&other) = default;
+    HelpText &operator=(const HelpText &other);
+
+    /// text that outlives the console, eg. a string literal, a static table or a mapped file.  Not copied
+    static HelpText borrow(std::string_view text);
+
+    /// the text.  Empty for help that hasn't been fetched from its provider yet; see QuakeStyleConsole::helpText()
+    std::string_view view() const { return text; }
+
+    bool empty() const { return text.empty() && !deferred; }
+    std::size_t length() const { return text.size(); }
+
+    /// whether the text is a copy owned by this object
+    bool copied() const { return owned != nullptr; }
+
+    /// whether the text comes from a provider the first time it's read
+    bool lazy() const { return deferred; }
+
+    /// prints the text as it stands; lazy help that hasn't been fetched prints nothing
+    friend std::ostream &operator<<(std::ostream &os, const HelpText &help) { return os << help.text; }
+
+  private:
+    friend class QuakeStyleConsole;
+
+    /// copies s
+    void assign(std::string_view s);
+
+    std::string_view text;
+    std::unique_ptr<char[]> owned; ///< the copy text points into, if any
+    bool deferred = false;         ///< the text comes from a provider in QuakeStyleConsole::helpProviders
+};
+
+// -----------------------------------------------------------------------------
+// Static symbol registry
+// Commands and cvars can be declared at compile time, in any translation unit, with VIRTUOSO_CONSOLE_STATIC_TABLE.
+// Each table is sorted at compile time and linked into a global list by a registrar with no allocation, so declaring
+// thousands of commands costs nothing at startup.  Consoles search the tables with a binary search when a command isn't in
+// their runtime symbol table, so runtime binds with the same name take precedence.  Static cvars are merged into the runtime
+// table the first time any cvar lookup misses, so they get versions like other cvars.
+//
+// VIRTUOSO_CONSOLE_STATIC_TABLE(myCommands,
+//     VIRTUOSO_CONSOLE_COMMAND("sum", printSum, "Sums two integers"),
+//     VIRTUOSO_CONSOLE_CVAR("gravity", g_gravity, "World gravity"));
+//
+// Commands may be any function pointer bindCommand accepts.  CVars must have static storage duration.
+// -----------------------------------------------------------------------------
+
+/// A command or cvar declared at compile time.  Make these with QuakeStyleConsole::staticCommand and QuakeStyleConsole::staticCVar
+struct StaticSymbol
+{
+    /// runs a command from the arguments
+    typedef void (*ArgsFunc)(QuakeStyleConsole &console, ConsoleArgs &args, std::ostream &os);
+
+    /// sets a custom type cvar from the arguments.  Returns false on a syntax error
+    typedef bool (*ReadFunc)(QuakeStyleConsole &console, ConsoleArgs &args, std::ostream &os);
+
+    /// prints a custom type cvar
+    typedef void (*PrintFunc)(QuakeStyleConsole &console, std::ostream &os);
+
+    std::string_view name;
+    ArgsFunc command = nullptr;
+    CVarType type = CVAR_NONE; ///< cvar storage type, if this is a cvar
+    void *data = nullptr;      ///< the variable, for native cvar types
+    ReadFunc read = nullptr;   ///< for CVAR_CUSTOM
+    PrintFunc print = nullptr; ///< for CVAR_CUSTOM
+    std::string_view help;
+};
+
+/// A sorted array of static symbols, and the link to the next registered table
+struct StaticSymbolTable
+{
+    const StaticSymbol *symbols;
+    std::size_t count;
+    const StaticSymbolTable *next;
+
+    /// binary search for name.  Returns nullptr if it isn't in the table
+    const StaticSymbol *find(std::string_view name) const;
+};
+
+/// head of the list of registered static tables.  Tables are pushed on the front as they register
+struct StaticSymbolRegistry
+{
+    inline static const StaticSymbolTable *head = nullptr;
+
+    /// searches every registered table for name.  Returns nullptr if it isn't in any
+    static const StaticSymbol *find(std::string_view name);
+};
+
+/// a static instance of this adds a table to the registry during static initialization
+class StaticSymbolRegistrar
+{
+    StaticSymbolTable table;
+
+  public:
+    StaticSymbolRegistrar(const StaticSymbol *symbols, std::size_t count) : table{symbols, count, StaticSymbolRegistry::head}
+    {
+        StaticSymbolRegistry::head = &table;
+    }
+};
+
+/// not constexpr, so reaching it while building a table at compile time is a compile error
+inline void duplicateStaticConsoleSymbol() {}
+
+/// copies the symbols into an array sorted by name, at compile time.  Duplicate names fail to compile
+template <std::size_t N>
+constexpr std::array<StaticSymbol, N> makeStaticSymbolTable(const StaticSymbol (&symbols)[N])
+{
+    std::array<StaticSymbol, N> table{};
+
+    for (std::size_t i = 0; i < N; i++)
+    {
+        StaticSymbol s = symbols[i];
+        std::size_t j = i;
+
+        for (; j > 0 && s.name < table[j - 1].name; j--)
+        {
+            table[j] = table[j - 1];
+        }
+
+        table[j] = s;
+    }
+
+    for (std::size_t i = 1; i < N; i++)
+    {
+        if (table[i].name == table[i - 1].name)
+        {
+            duplicateStaticConsoleSymbol();
+        }
+    }
+
+    return table;
+}
+
+#define VIRTUOSO_CONSOLE_COMMAND(name, function, help) Virtuoso::QuakeStyleConsole::staticCommand<function>(name, help)
+#define VIRTUOSO_CONSOLE_CVAR(name, variable, help) Virtuoso::QuakeStyleConsole::staticCVar<&variable>(name, help)
+
+#define VIRTUOSO_CONSOLE_STATIC_TABLE(tableName, ...)                                                 \
+    static constexpr auto tableName = Virtuoso::makeStaticSymbolTable<>({__VA_ARGS__});               \
+    static Virtuoso::StaticSymbolRegistrar tableName##Registrar(tableName.data(), tableName.size())
+
+class QuakeStyleConsole
+{
+  public:                                               // the methods in this section are what you should use in your code
+    static const unsigned int defaultHistorySize = 10u; ///size of the history file
+
+    /// istream based command signature.  Still accepted by bindCommand, which adapts it to a CommandFunc.
+    typedef std::function<void(std::istream &is, std::ostream &os)> ConsoleFunc;
+
+    /// native command signature.  Commands pull their arguments from the already tokenized line.
+    /// Stored inline, so binding and calling commands never touches the heap.  Anything with the right call signature converts to one.
+    typedef InplaceFunction<void(ConsoleArgs &args, std::ostream &os)> CommandFunc;
+
+    /// writes the value of a cvar to an output stream
+    typedef InplaceFunction<void(std::ostream &os)> PrintFunc;
+
+    /// sets a cvar from the command arguments.  Returns false on a syntax error
+    typedef InplaceFunction<bool(ConsoleArgs &args, std::ostream &os)> ReadFunc;
+
+    /// flags for bindCVar
+    enum CVarFlags
+    {
+        CVAR_READONLY = 1u << 0,  ///< can be read and echoed but not set from the console
+        CVAR_CACHE_TEXT = 1u << 1, ///< a custom type that only changes through the console or setCVar, so its printed value can be cached for $
+        CVAR_ARCHIVE = 1u << 2,    ///< saved by saveConfig()
+        CVAR_DYNAMIC = 1u << 3     ///< declared from the console with var.  Set by the console, not by bindCVar callers
+    };
+
+    /// A bound variable.  int, float, double, bool and std::string are stored as a typed pointer and read and written directly.
+    /// Any other type goes through a pair of closures.
+    struct CVar
+    {
+        CVarType type = CVAR_NONE;
+        unsigned flags = 0;        ///< CVarFlags
+        std::uint32_t version = 0; ///< incremented whenever the value is set through the console
+        void *data = nullptr;      ///< the variable, for native types
+        ReadFunc read;             ///< parses and sets the variable, for CVAR_CUSTOM
+        PrintFunc print;           ///< writes the variable, for CVAR_CUSTOM
+
+        // the printed value, reused by $ while the variable is unchanged.  Native types can change behind the console's back,
+        // so their value bits are kept too and compared; custom types are only cached with CVAR_CACHE_TEXT
+        mutable std::string text;
+        mutable std::uint64_t textBits = 0;
+        mutable std::uint32_t textVersion = 0;
+        mutable bool textCached = false;
+
+        std::uint32_t symbol = ~std::uint32_t(0); ///< the SymbolID this cvar is bound to
+        std::uint8_t watchModes = 0;              ///< WatchModes of the watchers that match this cvar
+        bool changePending = false;               ///< queued for the next dispatchChanges()
+
+        // the value last written or read by saveConfig() / loadConfig(), to tell whether an archived cvar has changed since
+        std::uint64_t savedBits = 0;
+        std::uint32_t savedVersion = 0;
+        bool saved = false;
+
+        explicit operator bool() const { return type != CVAR_NONE; }
+    };
+
+    /// makes the help text for a topic, for help set with setHelpProvider()
+    typedef std::function<std::string(std::string_view topic)> HelpProvider;
+
+    /// stable integer handle for a name in the symbol table
+    typedef std::uint32_t SymbolID;
+    static constexpr SymbolID invalidSymbol = ~SymbolID(0);
+
+    /// Everything the console knows about a name.  A name can be a command, a cvar (read and print), and a help topic at once.
+    struct Symbol
+    {
+        std::string_view name; ///< interned; null terminated
+        std::uint32_t hash;    ///< cached hash of name
+        CommandFunc command;   ///< the command bound to this name, if any
+        CVar cvar;             ///< the cvar bound to this name, if any
+        HelpText help;         ///< help string, if any
+    };
+
+    /// Read only view over the symbols that have a particular slot filled in.  Iterates as (name, slot) pairs, like the maps these used to be.
+    template <class T, T Symbol::*slot>
+    class SymbolView
+    {
+      public:
+        struct Entry
+        {
+            std::string_view first;
+            const T &second;
+        };
+
+        class const_iterator
+        {
+            typename std::deque<Symbol>::const_iterator it;
+            typename std::deque<Symbol>::const_iterator end;
+
+            void skip()
+            {
+                while (it != end && !present((*it).*slot))
+                    ++it;
+            }
+
+          public:
+            struct Arrow
+            {
+                Entry e;
+                const Entry *operator->() const { return &e; }
+            };
+
+            const_iterator(typename std::deque<Symbol>::const_iterator i, typename std::deque<Symbol>::const_iterator e) : it(i), end(e) { skip(); }
+
+            Entry operator*() const { return {it->name, (*it).*slot}; }
+            Arrow operator->() const { return {**this}; }
+
+            const_iterator &operator++()
+            {
+                ++it;
+                skip();
+                return *this;
+            }
+
+            const_iterator operator++(int)
+            {
+                const_iterator rval = *this;
+                ++(*this);
+                return rval;
+            }
+
+            bool operator==(const const_iterator &o) const { return it == o.it; }
+            bool operator!=(const const_iterator &o) const { return it != o.it; }
+        };
+
+        typedef const_iterator iterator;
+
+        SymbolView(const std::deque<Symbol> &s) : symbols(s) {}
+
+        const_iterator begin() const { return const_iterator(symbols.begin(), symbols.end()); }
+        const_iterator end() const { return const_iterator(symbols.end(), symbols.end()); }
+
+      private:
+        static bool present(const CommandFunc &f) { return bool(f); }
+        static bool present(const CVar &v) { return bool(v); }
+        static bool present(const HelpText &h) { return !h.empty(); }
+
+        const std::deque<Symbol> &symbols;
+    };
+
+    typedef SymbolView<CommandFunc, &Symbol::command> CommandTable;
+    typedef SymbolView<CVar, &Symbol::cvar> CVarTable;
+    typedef CVarTable CVarReadTable;  ///< kept for compatibility; same as CVarTable
+    typedef CVarTable CVarPrintTable; ///< kept for compatibility; same as CVarTable
+    typedef SymbolView<HelpText, &Symbol::help> HelpTable;
+
+    static const std::size_t defaultQueueCapacity = 1024u; ///< number of lines submit() can have waiting for drain()
+
+    /// Constructor binds the default commands to the command table & initializes history buffer and the submit() queue
+    QuakeStyleConsole(std::size_t maxHistory = defaultHistorySize, std::size_t queueCapacity = defaultQueueCapacity);
+
+    ~QuakeStyleConsole();
+
+    // --------------------------------------//
+    /* --------- COMMAND EXECUTION --------- */
+    // --------------------------------------//
+    // call one of these functions to make the console do things - eg. the first one when you press enter
+    // and your GUI console widget gives you a string
+    // You can execute all commands in an input stream until EOF with executeUntilEOF(),
+    // or run every line in a file (eg. a startup or debug playback file) with executeFile()
+    // Large scripts and command lists should go through executeBatch(), which sets up once for the whole batch and reports what happened
+
+    /// options for commandExecute.  Combine with |
+    enum ExecuteFlags : unsigned
+    {
+        EXECUTE_SILENT = 0u,                              ///< just run the commands
+        EXECUTE_ECHO = 1u << 0,                           ///< echo each line to the output before running it
+        EXECUTE_HISTORY = 1u << 1,                        ///< push each line onto the history buffer
+        EXECUTE_DEFAULT = EXECUTE_ECHO | EXECUTE_HISTORY, ///< what a user typing into the console expects
+        EXECUTE_SUMMARY = 1u << 2,                        ///< executeBatch only: write one line summarizing the batch when it finishes
+        EXECUTE_STOP_ON_ERROR = 1u << 3,                  ///< executeBatch only: stop after the first line that raises an error
+    };
+
+    /// what happened during an executeBatch
+    struct BatchResult
+    {
+        std::size_t lines = 0;                                  ///< lines executed, not counting blank lines and comments
+        std::size_t errors = 0;                                 ///< errors raised, see raiseError()
+        std::size_t failedLines = 0;                            ///< lines that raised at least one error
+        std::size_t firstErrorLine = std::string_view::npos;    ///< zero based line number of the first line that raised an error
+        double seconds = 0.0;                                   ///< wall clock time for the whole batch
+        bool stopped = false;                                   ///< EXECUTE_STOP_ON_ERROR ended the batch early
+    };
+
+    // Zero allocation dispatch : once the console has executed a few lines and its scratch buffers have grown,
+    // executing a line without EXECUTE_HISTORY doesn't touch the heap.  That covers set, echo, $ dereferencing,
+    // and commands bound through bindCommand / bindMemberCommand whose arguments parse without allocating (eg. numbers).
+    // Errors, new variables and commands that allocate themselves are the exceptions.  See AllocationProbe to check your own commands.
+
+    /// Execute the command line(s) passed in as a string.  Console output goes to "output"
+    void commandExecute(std::string_view str, std::ostream &output, unsigned flags = EXECUTE_DEFAULT);
+
+    /// Get a command line from the input stream and execute it.   Console output goes to "output"
+    void commandExecute(std::istream &input, std::ostream &output, unsigned flags = EXECUTE_DEFAULT);
+
+    /// execute commands from an istream until EOF
+    void executeUntilEOF(std::istream &f, std::ostream &output);
+
+    /// execute commands from a file (named by the input string 'f') until EOF, as a batch.
+    /// Regular files are memory mapped and executed in place; anything else (eg. a pipe) is streamed
+    BatchResult executeFile(const std::string &f, std::ostream &output, unsigned flags = EXECUTE_DEFAULT);
+
+    /// Executes every line in buffer, separated by newlines.  Scratch buffers are claimed once for the whole batch,
+    /// and with EXECUTE_HISTORY only the lines that will still be in the history window afterwards are pushed.
+    BatchResult executeBatch(std::string_view buffer, std::ostream &output, unsigned flags = EXECUTE_SILENT);
+
+    /// Executes count lines from an array
+    BatchResult executeBatch(const std::string_view *lines, std::size_t count, std::ostream &output, unsigned flags = EXECUTE_SILENT);
+
+    /// Executes a list of lines
+    BatchResult executeBatch(const std::vector<std::string> &lines, std::ostream &output, unsigned flags = EXECUTE_SILENT);
+
+    /// Executes every line read from input until EOF, reading in large blocks.  The stream can't be rewound, so with EXECUTE_HISTORY every line is pushed
+    BatchResult executeBatch(std::istream &input, std::ostream &output, unsigned flags = EXECUTE_SILENT);
+
+    /// Executes a script file through the compiled script cache.  The first run compiles the file: each line is tokenized once,
+    /// command names are resolved to symbols, and "set <cvar> <number>" lines are parsed to a typed literal.  Later runs skip all of that.
+    /// The cache entry is rebuilt when the file's modification time or size changes and its contents differ, or when a command is bound.
+    /// Lines that dereference variables with $ are kept as text and tokenized when they run, since their values can change.
+    BatchResult executeScript(const std::string &path, std::ostream &output, unsigned flags = EXECUTE_DEFAULT);
+
+    /// drops every compiled script
+    void clearScriptCache() { scriptCache.clear(); }
+
+    /// Runs a script a few lines at a time, so a long script can be spread across frames.  See startScript()
+    class ScriptExecutor;
+
+    /// Prepares a script file to run incrementally with ScriptExecutor::step().  It is compiled through the same cache as executeScript().
+    /// If the file can't be read the error goes to output and the executor comes back already done.
+    ScriptExecutor startScript(const std::string &path, std::ostream &output, unsigned flags = EXECUTE_DEFAULT);
+
+    /// Prepares script text to run incrementally.  The text is copied, so it doesn't need to outlive the executor
+    ScriptExecutor startScriptText(std::string_view text, unsigned flags = EXECUTE_DEFAULT);
+
+    // ------------------------------------//
+    /* ------ COMMANDS FROM OTHER THREADS -----*/
+    // ------------------------------------//
+    // The console itself belongs to one thread.  Other threads (workers, networking, tools) hand it command lines with submit(),
+    // which is lock free, and the owning thread runs them with drain(), eg. once per frame.
+
+    /// called on the draining thread after a submitted line runs, with everything it printed and its BatchResult
+    typedef std::function<void(std::string_view output, const BatchResult &result)> CompletionFunc;
+
+    /// Queues a command line (or several, separated by newlines) to run on the next drain().  Safe to call from any thread.
+    /// Returns false if the queue is full, in which case nothing was queued.
+    bool submit(std::string line, CompletionFunc done = nullptr);
+
+    /// Runs queued lines on the calling thread, which must own the console, until the queue is empty, maxLines have run, or
+    /// timeBudget has passed.  Output goes to os, and to the line's completion callback if it has one.  Returns the number of lines run.
+    std::size_t drain(std::ostream &os, std::size_t maxLines = std::numeric_limits<std::size_t>::max(),
+                      std::chrono::microseconds timeBudget = std::chrono::microseconds::max(), unsigned flags = EXECUTE_ECHO);
+
+    // ------------------------------------//
+    /* ------------- WAITING ------------- */
+    // ------------------------------------//
+    // Scripts run with runFile, executeScript() or startScript() can pause with "wait <frames>" or "sleep <ms>".  The rest of the
+    // script is parked, and the host resumes it by calling tick() once per frame.  wait takes effect at the end of its line,
+    // and is ignored outside a compiled script.
+
+    /// Advances the frame counter, resumes the parked scripts and coroutines that are ready, and prints what async jobs have written since the last tick.
+    /// Their output goes to os
+    void tick(std::ostream &os);
+
+    /// number of tick() calls so far
+    std::uint64_t frame() const { return frameNumber; }
+
+    /// number of parked scripts and coroutines
+    std::size_t waitingCount() const;
+
+    /// drops every parked script and coroutine without running the rest of them
+    void clearWaiting();
+
+#ifdef VIRTUOSO_CONSOLE_COROUTINES
+    /// What nextFrame() and sleep() return.  co_await gives back the stream passed to tick(), to print to after resuming
+    struct WaitAwaiter
+    {
+        QuakeStyleConsole &console;
+        std::uint64_t frames;
+        std::chrono::steady_clock::duration time;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle);
+        std::ostream &await_resume() const noexcept { return *console.tickOutput; }
+    };
+
+    /// In a ConsoleTask coroutine, co_await console.nextFrame() resumes it on a later tick().  Eg.
+    /// console.bindCommand("fade", std::function<void(float)>([&](float seconds) -> ConsoleTask { ... co_await console.nextFrame(); ... }));
+    WaitAwaiter nextFrame(unsigned frames = 1) { return {*this, frames, std::chrono::steady_clock::duration::zero()}; }
+
+    /// co_await console.sleep(ms) resumes the coroutine on the first tick() after ms have passed
+    WaitAwaiter sleep(std::chrono::milliseconds ms) { return {*this, 0, ms}; }
+#endif
+
+    // ------------------------------------//
+    /* ---------- ASYNC COMMANDS ---------- */
+    // ------------------------------------//
+    // Slow commands (asset scans, rebuilds, dumps) can run on the console's worker threads so the frame keeps going.
+    // The arguments are parsed on the calling thread, then the body runs on a worker with a ConsoleJob to print to and to poll for cancellation.
+    // Output comes back through tick().  The body must not touch the console; it can submit() lines to it.  The built in jobs command lists and cancels them.
+
+    static const unsigned defaultJobThreads = 2u;
+
+    /// binds a command whose body runs on a worker thread.  eg. console.bindAsyncCommand("scan", std::function<void(ConsoleJob&, std::string)>(scanAssets));
+    template <typename... Args>
+    void bindAsyncCommand(const std::string &commandName, std::function<void(ConsoleJob &, Args...)> fun, HelpText help = HelpText());
+
+    /// Queues body on the worker threads as a job named name, and returns it.  Unlisted jobs are left out of jobList() and don't
+    /// report when they finish, for housekeeping the user didn't ask for, like completion's directory listings
+    std::shared_ptr<ConsoleJob> startJob(std::string name, std::function<void(ConsoleJob &)> body, bool listed = true);
+
+    /// cancels the job with the given id.  Returns false if there isn't one
+    bool cancelJob(unsigned id);
+
+    /// the queued and running jobs, and finished ones whose output hasn't been printed by tick() yet
+    const std::vector<std::shared_ptr<ConsoleJob>> &jobList() const { return jobs; }
+
+    /// number of jobs in jobList()
+    std::size_t jobCount() const { return jobs.size(); }
+
+    /// number of worker threads.  Takes effect when the first job starts
+    void setJobThreads(unsigned count) { jobThreadCount = count ? count : 1; }
+
+    // ------------------------------------//
+    /* -------------- ALIASES -------------*/
+    // ------------------------------------//
+    // An alias names a list of commands separated by ;  eg. alias jumpshoot "+jump; +attack".  The body is tokenized once when it's
+    // defined and each command's name resolved, so running an alias goes straight to the commands.  Commands that use $ are
+    // tokenized when they run, so they see the current values.  Aliases can call each other, up to maxAliasDepth deep, and cycles are reported as errors.
+
+    static constexpr std::size_t maxAliasDepth = 32u;
+
+    /// defines or redefines an alias.  Returns false if name is already a command
+    bool setAlias(std::string_view name, std::string_view body);
+
+    /// removes an alias.  Returns false if there isn't one
+    bool removeAlias(std::string_view name);
+
+    /// the body of an alias as it was defined, or null if there isn't one
+    const std::string *aliasBody(std::string_view name) const;
+
+    /// Writes the error style prefix to os and counts the error for BatchResult.  Use it to report errors from your own commands:
+    /// console.raiseError(os) << "bad input" << std::endl;
+    struct EndOfLineEscapeStreamScope;
+    EndOfLineEscapeStreamScope raiseError(std::ostream &os);
+
+    /// total number of errors raised by this console
+    std::uint64_t errorsRaised() const { return errorCount; }
+
+    //------------------------------------//
+    /*----------- ADDING CVARS -----------*/
+    //-------------------------------------//
+    // Call one of these to add variables (eg, Player.health) from your c++ code to the console.
+    // This makes them available to built in commands using the given "varname" - dereference them with $, print them with echo, and set them with "set"
+
+    /// function which takes in a string and a variable from client code we want to associate with it in the console.  Takes in an optional help string to describe the variable to the user, and CVarFlags.
+    template <class T>
+    void bindCVar(const std::string &varname, T &var, HelpText help = HelpText(), unsigned flags = 0);
+
+    // Typed access to cvars from C++, with no text formatting.  These work on the native types (int, float, double, bool, std::string)
+    // and T must match the bound type exactly.
+
+    /// returns a pointer to the variable if name is a cvar of type T, otherwise nullptr.  Keep it to poll the cvar with no lookup at all
+    template <class T>
+    const T *findCVar(std::string_view name);
+
+    /// returns the value of the cvar if name is a cvar of type T, otherwise nothing
+    template <class T>
+    std::optional<T> getCVar(std::string_view name);
+
+    /// sets the cvar and bumps its version.  Returns false if name isn't a cvar of type T.  Read only cvars can be set from C++
+    template <class T>
+    bool setCVar(std::string_view name, const T &value);
+
+    /// returns the record for a cvar, or nullptr.  Its version changes whenever the value is set through the console
+    const CVar *getCVarRecord(std::string_view name) { return lookupCVar(name); }
+
+    // Watchers are told when cvars are set through the console or setCVar, so code that depends on a cvar doesn't have to poll it.
+    // Changes made directly to a bound variable from C++ aren't seen.
+
+    /// when a watcher is called
+    enum WatchMode : std::uint8_t
+    {
+        WATCH_IMMEDIATE = 1u << 0, ///< during the set, once per set
+        WATCH_COALESCED = 1u << 1  ///< from dispatchChanges(), once per changed cvar however many times it was set
+    };
+
+    /// called with the name and record of the cvar that changed
+    typedef std::function<void(std::string_view name, const CVar &cvar)> CVarWatchFunc;
+
+    typedef std::uint32_t WatchID;
+
+    /// watches one cvar, which doesn't have to be bound yet.  Returns an id for unwatchCVar()
+    WatchID watchCVar(std::string_view name, CVarWatchFunc f, WatchMode mode = WATCH_COALESCED);
+
+    /// watches every cvar whose name starts with prefix, including ones bound later.  eg. watchCVarPrefix("r_", rebuildRenderer)
+    WatchID watchCVarPrefix(std::string_view prefix, CVarWatchFunc f, WatchMode mode = WATCH_COALESCED);
+
+    /// removes a watcher.  Safe to call from inside a watcher
+    void unwatchCVar(WatchID id);
+
+    /// Calls the WATCH_COALESCED watchers of every cvar set since the last call.  Call it once per frame, wherever suits the host.
+    /// Returns the number of watcher calls
+    std::size_t dispatchChanges();
+
+    // ------------------------------------//
+    /* --------- ADDING COMMANDS ----------*/
+    // ------------------------------------//
+    // You should call console.bindCommand() with the command name you want and a C++ function from your code with an arbitrary signature.  Optionally provide a help string for the command as a third argument
+    // You shouldn't need to worry about which overload or template arguments to use - it should resolve automatically.
+    // If your function has arguments, so long as there is an istream operator to read them from the input,
+    // the console will automatically parse them with variadic template and lambda magic, so you never have to write a parser
+    // IF YOU ARE USING A MEMBER FUNCTION - we need to wrap the "this" pointer too, so call bindMemberCommand() which takes the object reference as the first argument after the command name
+
+    /// add a command to the console using a function pointer that takes no arguments.  set the associated help string to the "help" argument
+    void bindCommand(const std::string &commandName, void (*fptr)(void), HelpText help = HelpText());
+
+    ///add a command to the console using a function pointer that takes arbitrary arguments, then set the associated help string to the "help" argument
+    template <typename... Args>
+    void bindCommand(const std::string &commandName, void (*fptr)(Args...), HelpText help = HelpText());
+
+    ///add a command to the console using a function object with arbitrary arguments, then set the associated help string to the optional "help" argument
+    template <typename... Args>
+    void bindCommand(const std::string &commandName, std::function<void(Args...)> fun, HelpText help = HelpText());
+
+    /// same as bindCommand, but for a member function of an object.  Object instance is first argument after the command name
+    template <typename O, typename... Args>
+    void bindMemberCommand(const std::string &commandName, O &obj, void (O::*fptr)(Args...), HelpText help = HelpText());
+
+    /// add a command that reads its input from an istream.  It is adapted to a CommandFunc over the remainder of the line.  Takes optional help string.
+    void bindCommand(const std::string &commandName, ConsoleFunc f, HelpText help = HelpText());
+
+    /// the bindCommand that actually does the work of adding commands to the table AFTER they've been coerced to a CommandFunc that takes the tokenized arguments.  Takes optional help string.
+    void bindCommand(const std::string &commandName, CommandFunc f, HelpText help = HelpText());
+
+    // ------------------------------------//
+    /* --------- STATIC COMMANDS ----------*/
+    // ------------------------------------//
+    // Commands and cvars declared at compile time.  See VIRTUOSO_CONSOLE_STATIC_TABLE above.
+
+    /// describes a compile time command.  F is a function pointer with any signature bindCommand accepts, or one taking (QuakeStyleConsole&, ConsoleArgs&, std::ostream&)
+    template <auto F>
+    static constexpr StaticSymbol staticCommand(std::string_view name, std::string_view help = std::string_view());
+
+    /// describes a compile time cvar.  V points to a variable with static storage duration
+    template <auto *V>
+    static constexpr StaticSymbol staticCVar(std::string_view name, std::string_view help = std::string_view());
+
+    /// Copies the registered static symbols into the runtime symbol table, without replacing anything bound at runtime.
+    /// Lookups don't need this, but enumerating the tables does; listCmd and friends call it.  Call it before iterating getCommandTable() etc. yourself.
+    void mergeStaticSymbols();
+
+    // ------------------------------------//
+    /* --------- HISTORY FILES ----------- */
+    // ------------------------------------//
+    /* Saving and loading the history buffer of previously executed commands to file  */
+
+    /// populate the command buffer from an input file named by string inFile
+    bool loadHistoryBuffer(const std::string &inFile);
+
+    /// write the history buffer to file named by string outFile
+    void saveHistoryBuffer(const std::string &outFile);
+
+    /// populate the command buffer from an input file named by istream inFile
+    void loadHistoryBuffer(std::istream &inFile);
+
+    /// write the history buffer to file named by ostream outFile
+    void saveHistoryBuffer(std::ofstream &outfile);
+
+    // ------------------------------------//
+    /* --------- CONFIG FILES ------------ */
+    // ------------------------------------//
+    // cvars bound with CVAR_ARCHIVE are saved to a config file of set commands.  Each cvar remembers the value it last saved or
+    // loaded.  saveConfig compares every archived cvar against it, which for a string means hashing it, and doesn't touch the file
+    // if none changed.  Otherwise it formats the lines of the cvars that changed, reuses the lines it wrote last time for the rest,
+    // and writes the whole file.  Native types are compared by value, so changes made from C++ count; custom types count as
+    // changed when they're set through the console.
+
+    enum SaveResult
+    {
+        SAVE_FAILED,  ///< the file couldn't be written.  The old file, if any, is untouched
+        SAVE_SKIPPED, ///< nothing changed since the last save or load of this file
+        SAVE_WRITTEN
+    };
+
+    /// Writes every archived cvar to path, replacing the file atomically through a temporary file and a rename.
+    /// Skipped if no archived cvar changed since the last saveConfig or loadConfig of the same path, unless force is set.
+    /// A string holding a quote or a line break, or custom text that would break its set line (see appendLineText), can't be
+    /// written, so the file keeps the last value of it that could be, and it stays counted by unsavedCVarCount().
+    SaveResult saveConfig(const std::string &path, bool force = false);
+
+    /// Runs a config file written by saveConfig, memory mapped and without echo or history.  Everything it sets counts as saved
+    BatchResult loadConfig(const std::string &path, std::ostream &os);
+
+    /// number of archived cvars that changed since they were last saved or loaded
+    std::size_t unsavedCVarCount();
+
+    // ------------------------------------//
+    /* --------- STATE SNAPSHOTS --------- */
+    // ------------------------------------//
+    // A snapshot is a binary image of every cvar, the variables declared with var, and the history buffer, for restoring
+    // console state at startup without parsing a config.  Numbers are stored as their raw bits; strings, custom types and vars as text.
+    // Each entry keeps the SymbolID and name hash it was saved from, so loading into the same build goes straight to the symbol with
+    // no lookup.  Entries whose symbol moved are looked up by name, and entries whose type changed are replayed as set commands.
+
+    static constexpr std::uint32_t snapshotVersion = 1; ///< bumped whenever the file layout changes
+
+    /// what happened during a loadSnapshot
+    struct SnapshotResult
+    {
+        bool loaded = false;      ///< false if the file is missing, damaged or from another snapshotVersion.  Fall back to a text config
+        std::size_t direct = 0;   ///< entries applied through their saved SymbolID
+        std::size_t lookedUp = 0; ///< entries found by name because the symbol table changed, or vars declared again
+        std::size_t replayed = 0; ///< entries whose type changed, set from text
+        std::size_t skipped = 0;  ///< cvars that aren't bound in this build, are read only, or need replaying a value a set line can't hold
+        std::size_t history = 0;  ///< history lines restored
+        double seconds = 0.0;     ///< wall clock time for the whole load
+    };
+
+    /// Writes a snapshot of every settable cvar, every var and the history buffer to path, replacing the file atomically.  Returns false if it couldn't be written
+    bool saveSnapshot(const std::string &path);
+
+    /// Restores a snapshot written by saveSnapshot, memory mapped.  The history buffer is replaced.  Set commands replayed for changed types report errors to os
+    SnapshotResult loadSnapshot(const std::string &path, std::ostream &os);
+
+    // ------------------------------------//
+    /* ----------OUTPUT STYLING------------*/
+    // ------------------------------------//
+
+    /// begin / end pairs that wrap output of a certain type
+    struct ConsoleStyling
+    {
+        std::pair<std::string, std::string> error;
+        std::pair<std::string, std::string> warning;
+        std::pair<std::string, std::string> echo;
+    };
+
+    /// ANSI color codes wrap the output in the scope.
+    inline static ConsoleStyling ConsoleStylingColor() { return {{"\u001b[37;41;1m[error]: ", "\u001b[0m"}, {"\u001b[33;1m[warning]: ", "\u001b[0m"}, {"\u001b[32;1m> ", "\u001b[0m"}}; }
+
+    /// Styling parameters with no colors, just tags
+    inline static ConsoleStyling ConsoleStylingPlain() { return {{"[error]: ", ""}, {"[warning]: ", ""}, {"> ", ""}}; }
+
+    ConsoleStyling style = ConsoleStylingPlain(); ///< public so user can modify.  Initialized using uncolored output
+
+    // - sugared getters for console implementation -
+
+    const std::pair<std::string, std::string> &error() { return style.error; }
+    const std::pair<std::string, std::string> &warning() { return style.warning; }
+    const std::pair<std::string, std::string> &echo() { return style.echo; }
+
+    // ------------------------------------//
+    /* ----OTHER GETTERS AND SETTERS-------*/
+    // ------------------------------------//
+
+    /// sets the help string (see built in 'help' command) for a given topic.  The text is copied unless it's a HelpText::borrow(); see HelpText
+    void setHelpTopic(const std::string &topic, HelpText data);
+
+    /// gives a topic help that provider makes the first time it's read, eg. from a localization table.  The result is kept
+    void setHelpProvider(const std::string &topic, HelpProvider provider);
+
+    /// Reads help topics from a file laid out as "@topic" lines, each followed by its text.  The file stays memory mapped and
+    /// the help text stays in the mapping, so it's never copied and only paged in when someone reads it.  Returns false if it can't be read
+    bool loadHelpFile(const std::string &path);
+
+    /// the help text for a topic, fetching it from its provider if it has one.  Empty if there's no help for topic
+    std::string_view helpText(std::string_view topic);
+
+    /// where the help text is stored
+    struct HelpStats
+    {
+        std::size_t topics = 0;        ///< topics with help
+        std::size_t borrowedBytes = 0; ///< text kept as views by HelpText::borrow(), static tables and help files.  Copying these is the memory saved
+        std::size_t copiedBytes = 0;   ///< text copied from literals, arrays, std::strings, char pointers and providers
+        std::size_t copies = 0;        ///< allocations holding copied text
+        std::size_t lazyTopics = 0;    ///< topics whose provider hasn't been called yet
+    };
+
+    HelpStats helpStats() const;
+
+    const std::deque<std::string> &historyBuffer() const;
+    inline CommandTable getCommandTable() const { return CommandTable(symbols.all()); }
+    inline CVarTable getCVarTable() const { return CVarTable(symbols.all()); }
+    inline CVarReadTable getCVarReadTable() const { return CVarReadTable(symbols.all()); }
+    inline CVarPrintTable getCVarPrintTable() const { return CVarPrintTable(symbols.all()); }
+    inline HelpTable getHelpTable() const { return HelpTable(symbols.all()); }
+
+    /// returns the id of a command, cvar, or help topic, or invalidSymbol if the name isn't known.  Ids are stable for the lifetime of the console.
+    inline SymbolID findSymbol(std::string_view name) const { return symbols.find(name); }
+
+    /// returns the record for a symbol id from findSymbol
+    inline const Symbol &getSymbol(SymbolID id) const { return symbols[id]; }
+
+    /// what a symbol is, for completion.  Combine with |
+    enum SymbolKind : unsigned
+    {
+        SYMBOL_COMMAND = 1u << 0,
+        SYMBOL_CVAR = 1u << 1,
+        SYMBOL_HELP = 1u << 2, ///< has a help topic
+        SYMBOL_ANY = SYMBOL_COMMAND | SYMBOL_CVAR | SYMBOL_HELP
+    };
+
+    /// Appends the ids of the symbols of the given kinds whose names start with prefix, ignoring case, to matches, in case-insensitive name order.
+    /// Returns the length of the prefix all of them share, ignoring case, or 0 if there were none.  Names are kept in a sorted index,
+    /// so this costs a binary search plus the matches rather than a scan of every symbol.  When prefix extends the last one asked for,
+    /// as it does while typing, the search only covers the last one's matches.
+    std::size_t completeName(std::string_view prefix, std::vector<SymbolID> &matches, unsigned kinds = SYMBOL_COMMAND | SYMBOL_CVAR);
+
+    /// a fuzzyComplete() result
+    struct FuzzyMatch
+    {
+        SymbolID id;
+        int score; ///< higher is better
+    };
+
+    /// Finds the symbols of the given kinds whose names contain the letters of query in order, ignoring case, like a command palette.
+    /// Matches at the start of the name, at the start of words (after _ or . or at a capital) and runs of adjacent letters score higher.
+    /// Appends the best maxResults to results, best first, and returns how many were appended.  Names are scanned from one packed,
+    /// lower cased copy, after a letter bitmask filter throws out names that are missing any of the query's letters.
+    /// The names the last query didn't rule out are kept, so a query that extends it, as typing does, only looks at those, and
+    /// asking again for the same thing returns the last results.  Binding anything starts the next query over from every name.
+    std::size_t fuzzyComplete(std::string_view query, std::vector<FuzzyMatch> &results, std::size_t maxResults = 16, unsigned kinds = SYMBOL_ANY);
+
+    // ------------------------------------//
+    /* ------------ COMPLETION ----------- */
+    // ------------------------------------//
+    // complete() finds what the word under the cursor could be.  The first word of a command is completed from the command and cvar
+    // names.  Arguments go to the command's CompletionProvider, if it has one, so set <Tab> lists cvars and runFile <Tab> lists files.
+    // Commands without a provider complete their arguments as names too, since a line can chain several commands.
+
+    /// what complete() found
+    struct CompletionResult
+    {
+        std::size_t wordBegin = 0;           ///< the candidates replace the characters of the line from wordBegin
+        std::size_t wordEnd = 0;             ///< up to wordEnd, the cursor
+        std::size_t argument = 0;            ///< which argument of the command the word is, or 0 for the command name itself
+        SymbolID command = invalidSymbol;    ///< the command whose argument is being completed
+        std::vector<std::string> candidates; ///< in the order the provider gave them
+        std::size_t commonLength = 0;        ///< length of the prefix every candidate shares, ignoring case
+        bool fuzzy = false;                  ///< nothing started with the word, so these are fuzzyComplete() suggestions that don't either
+        bool pending = false;                ///< a provider is still gathering candidates in the background.  Ask again on a later frame
+    };
+
+    /// Adds the candidates for one argument to result.candidates.  word is what's been typed of it so far; argument counts from 1.
+    /// Called on the console's thread, so it must not block : anything slow should happen in the background and set result.pending until it's done.
+    typedef std::function<void(std::string_view word, std::size_t argument, CompletionResult &result)> CompletionProvider;
+
+    /// gives a command a provider for its arguments.  The built in commands that take names or files come with one
+    void setCompletion(const std::string &command, CompletionProvider provider);
+
+    /// Completes the word that ends at cursor in line.  result is cleared first; its vectors keep their storage.
+    void complete(std::string_view line, std::size_t cursor, CompletionResult &result);
+
+    /// completes the first argument from the cvar names
+    CompletionProvider cvarNameCompletion();
+
+    /// completes the first argument from the help topics
+    CompletionProvider helpTopicCompletion();
+
+    /// Completes the first argument as a path under root.  Directories are listed on the job threads and cached, so the input never
+    /// waits on the disk.  A listing older than refreshSeconds is served as is while it's listed again in the background.
+    CompletionProvider filePathCompletion(std::string root = ".", double refreshSeconds = 2.0);
+
+  protected:
+    /// WindowedQueue - We implement a ring buffer for the command history as a queue
+    template <class T>
+    class WindowedQueue : public std::deque<T>
+    {
+        void fix_size()
+        {
+            while (std::deque<T>::size() > m_capacity)
+            {
+                std::deque<T>::pop_front();
+            }
+        }
+
+        std::size_t m_capacity;
+
+      public:
+        WindowedQueue(std::size_t maxCapacity) : m_capacity(maxCapacity)
+        {
+        }
+
+        void capacity(std::size_t newCapacity)
+        {
+            m_capacity = newCapacity;
+            fix_size();
+        }
+
+        std::size_t capacity() const
+        {
+            return m_capacity;
+        }
+        using std::deque<T>::operator[];
+
+        template <class... Args>
+        void emplace(Args &&... args)
+        {
+            std::deque<T>::emplace_back(std::forward<Args>(args)...);
+            fix_size();
+        }
+
+        void push(const T &value)
+        {
+            std::deque<T>::push_back(value);
+            fix_size();
+        }
+
+        void push(T &&value)
+        {
+            std::deque<T>::push_back(value);
+            fix_size();
+        }
+        void pop()
+        {
+            std::deque<T>::pop_front();
+        }
+    };
+
+    typedef WindowedQueue<std::string> ConsoleHistoryBuffer;
+
+    ConsoleHistoryBuffer history_buffer; ///< history buffer of previous commands
+
+    /// character range of a token, relative to the start of the tokenized text
+    struct TokenSpan
+    {
+        std::size_t begin;
+        std::size_t length;
+    };
+
+    /// Scratch storage for one command line.  Reused between lines so steady state execution doesn't allocate.
+    struct LineScratch
+    {
+        std::string input;                    ///< line read from an istream
+        std::string expanded;                 ///< line text after $ expansion.  Only used when the line contains a $
+        std::vector<TokenSpan> spans;         ///< token ranges, built during tokenization
+        std::vector<std::string_view> tokens; ///< token views handed to commands
+        std::string_view text;                ///< the text the tokens point into
+    };
+
+    /// one scratch per nesting level, since commands like runFile execute lines while their own line is still live.  deque so references stay valid on growth
+    std::deque<LineScratch> lineScratch;
+    std::size_t executionDepth = 0; ///< number of lines currently executing
+
+    /// RAII claim on the scratch for the current nesting level
+    struct ScratchScope
+    {
+        QuakeStyleConsole &console;
+        LineScratch &scratch;
+
+        ScratchScope(QuakeStyleConsole &con);
+        ~ScratchScope() { console.executionDepth--; }
+    };
+
+    /// Open addressing hash table of interned names.  Each name is stored once, in a chunked arena, and maps to a stable SymbolID
+    /// indexing a single record holding its command, cvar read / print functions and help string.
+    /// Symbols are never removed, so there are no tombstones and ids never move.
+    class SymbolTable
+    {
+      public:
+        /// returns the id for name, or invalidSymbol
+        SymbolID find(std::string_view name) const;
+
+        /// returns the id for name, creating an empty symbol for it if needed
+        SymbolID intern(std::string_view name);
+
+        Symbol &operator[](SymbolID id) { return symbols[id]; }
+        const Symbol &operator[](SymbolID id) const { return symbols[id]; }
+
+        std::size_t size() const { return symbols.size(); }
+
+        const std::deque<Symbol> &all() const { return symbols; }
+
+        /// FNV-1a
+        static std::uint32_t hash(std::string_view name);
+
+        /// the ids of every name starting with prefix, ignoring case, in case-insensitive order.  Valid until the next intern().
+        /// A prefix extending the last one is only searched for within the last one's range
+        std::pair<const SymbolID *, const SymbolID *> prefixRange(std::string_view prefix);
+
+        /// case-insensitive name order, with case-sensitive order between names that differ only in case
+        static bool nameLess(std::string_view a, std::string_view b);
+
+        /// length of the prefix a and b share, ignoring case
+        static std::size_t commonPrefix(std::string_view a, std::string_view b);
+
+      private:
+        struct Slot
+        {
+            std::uint32_t hash = 0;
+            SymbolID id = invalidSymbol;
+        };
+
+        static constexpr std::size_t nameBlockSize = 4096u;
+
+        std::vector<Slot> slots;                        ///< power of two sized, linear probing, kept under half full
+        std::deque<Symbol> symbols;                     ///< indexed by SymbolID.  deque so references stay valid as it grows
+        std::vector<std::unique_ptr<char[]>> nameBlocks; ///< interned name storage
+        std::size_t nameBlockUsed = nameBlockSize;      ///< bytes used in the last name block
+
+        // names sorted for prefix queries.  New names go on the unsorted tail, which is sorted and merged in by the next query,
+        // so binding thousands of symbols at startup costs one sort instead of an insertion each
+        std::vector<SymbolID> sortedNames;
+        std::vector<SymbolID> unsortedNames;
+
+        // the last prefixRange() query and where its matches were in sortedNames, until the next merge moves them
+        std::string lastPrefix;
+        std::size_t lastFirst = 0;
+        std::size_t lastLast = 0;
+        bool lastValid = false;
+
+        /// copies name into the arena with a null terminator
+        std::string_view storeName(std::string_view name);
+
+        /// resizes and repopulates the slot array
+        void rehash(std::size_t slotCount);
+    };
+
+    /// every command, cvar and help topic
+    SymbolTable symbols;
+
+    /// Every symbol name packed end to end for fuzzyComplete(), indexed by SymbolID, so scanning them never touches the symbol records.
+    /// Symbols are never removed, so new ones are appended as they show up.
+    struct FuzzyIndex
+    {
+        std::string names;                  ///< each name lower cased, then as written, each followed by a null
+        std::vector<std::uint32_t> offsets; ///< start of each lower cased name in names
+        std::vector<std::uint32_t> lengths; ///< length of each name
+        std::vector<std::uint32_t> masks;   ///< letterMask() of each name
+    };
+
+    FuzzyIndex fuzzyIndex;
+    std::vector<FuzzyMatch> fuzzyHeap;     ///< the best matches so far during fuzzyComplete(), kept to reuse its storage
+    std::vector<SymbolID> fuzzyCandidates; ///< names that passed the letter filter, kept to reuse its storage
+
+    /// what the last fuzzyComplete() ruled out, so the next keystroke doesn't scan every name again
+    struct FuzzyNarrowing
+    {
+        std::string query;               ///< lower cased.  Empty when there's nothing to narrow
+        std::uint64_t namesVersion = 0;  ///< when the query ran.  Anything bound since could be a match the survivors don't have
+        std::vector<SymbolID> survivors; ///< in id order, every name that wasn't shown to be missing the query's letters
+        std::size_t maxResults = 0;      ///< with kinds, whether fuzzyHeap still holds the answer to the same query
+        unsigned kinds = 0;
+    };
+
+    FuzzyNarrowing fuzzyNarrowing;
+
+    std::unordered_map<SymbolID, CompletionProvider> completers; ///< see setCompletion()
+    std::vector<SymbolID> completeIds;                         ///< reused by complete() and the name providers
+    std::vector<FuzzyMatch> completeFuzzy;                     ///< reused by complete()
+
+    /// adds the names of the given kinds that start with word to result
+    void completeNames(std::string_view word, unsigned kinds, CompletionResult &result);
+
+    /// a bit for each letter a to z, one for any digit, one for _ and one for anything else, ignoring case
+    static std::uint32_t letterMask(std::string_view text);
+
+    /// scores name against the lower cased query, or returns false if the query's letters don't appear in order
+    static bool fuzzyScore(std::string_view lowerName, std::string_view name, std::string_view lowerQuery, int &score);
+
+    /// registry head as of the last mergeStaticSymbols()
+    const StaticSymbolTable *mergedStaticHead = nullptr;
+
+    /// calls a static command's function pointer after parsing its arguments.  specialized on the function type below
+    template <class Sig>
+    struct StaticInvoker;
+
+    /// sets a static cvar
+    template <auto *V>
+    static bool staticRead(QuakeStyleConsole &console, ConsoleArgs &args, std::ostream &os) { return console.setCvar(args, os, V); }
+
+    /// prints a static cvar
+    template <auto *V>
+    static void staticPrint(QuakeStyleConsole &console, std::ostream &os) { console.printCvar(os, V); }
+
+    ///function which simply sets the value of an arbitrary type based on the remaining arguments.  Returns false on a syntax error
+    template <class T>
+    bool setCvar(ConsoleArgs &args, std::ostream &os, T *var);
+
+    /// finds the cvar record for name, merging in the static tables first if some haven't been.  nullptr if there's no such cvar
+    CVar *lookupCVar(std::string_view name);
+
+    /// sets a cvar from the arguments through its native type or its closure, and bumps its version.  Returns false on a syntax error
+    bool readCVar(CVar &cvar, ConsoleArgs &args, std::ostream &os);
+
+    /// prints a cvar through its native type or its closure
+    void writeCVar(const CVar &cvar, std::ostream &os);
+
+    /// the printed value of a cvar without the trailing newline.  Cached until the value changes, see CVar::text
+    std::string_view cvarText(const CVar &cvar);
+
+    /// a cvar or prefix watcher
+    struct CVarWatcher
+    {
+        WatchID id;
+        WatchMode mode;
+        bool prefix;
+        SymbolID symbol;      ///< the watched cvar, if not prefix
+        std::string name;     ///< the prefix, if prefix
+        CVarWatchFunc func;   ///< null once removed
+    };
+
+    /// deque so a watcher being called stays put if another one is added
+    std::deque<CVarWatcher> watchers;
+    WatchID nextWatchID = 1;
+    std::size_t watchDepth = 0;          ///< watchers being called; removed watchers are only erased at 0
+    std::vector<SymbolID> changedCVars;  ///< cvars set since the last dispatchChanges()
+    std::vector<SymbolID> dispatchList;  ///< the batch being dispatched, kept to reuse its storage
+
+    /// records a set : bumps the version and tells the watchers
+    void cvarChanged(CVar &cvar);
+
+    /// whether a watcher applies to the cvar with the given symbol
+    bool watcherMatches(const CVarWatcher &w, SymbolID symbol) const;
+
+    /// calls the watchers with the given mode that match cvar.  Returns the number called
+    std::size_t callWatchers(CVar &cvar, WatchMode mode);
+
+    /// recomputes CVar::watchModes for one cvar, or every cvar
+    void refreshWatchModes(CVar &cvar);
+    void refreshWatchModes();
+
+    /// adds a watcher
+    WatchID addWatcher(CVarWatcher w);
+
+    std::vector<SymbolID> archivedCVars; ///< cvars bound with CVAR_ARCHIVE, in binding order
+
+    /// the line saveConfig() last formatted for an archived cvar, and the value it was formatted from
+    struct ArchivedLine
+    {
+        std::string text;
+        std::uint64_t bits = 0;    ///< cvarBits() when formatted
+        std::uint32_t version = 0; ///< CVar::version when formatted
+        bool valid = false;
+        bool written = false;      ///< the cvar is archived and not read only, so the line goes in the file
+        bool rejected = false;     ///< the value can't be written as a set line, so text still holds the last one that could be
+    };
+
+    std::vector<ArchivedLine> archivedLines; ///< parallel to archivedCVars
+    std::string lastConfigPath;          ///< the file the saved values in the archived cvars belong to
+    std::string configText;              ///< reused buffer for saveConfig()
+    bool loadingConfig = false;          ///< loadConfig() is running, so sets mark cvars saved
+
+    /// a value that changes when the cvar's value does : the bits of native numbers, a hash of strings, the version of custom types
+    std::uint64_t cvarBits(const CVar &cvar) const;
+
+    /// whether an archived cvar differs from its saved value
+    bool cvarUnsaved(const CVar &cvar) const;
+
+    /// records the cvar's current value as saved
+    void markCVarSaved(CVar &cvar);
+
+    /// formats a float or double with enough digits to read back the exact value, which the printed form doesn't promise
+    static std::string_view exactNumberText(CVarType type, double value, char (&buf)[40]);
+
+    /// Appends value to out as one token that reads back as exactly value : quoted when it's empty, holds whitespace, or starts
+    /// with # or $, which would make it a comment or a variable.  The tokenizer has no escapes, so a value holding a quote or a
+    /// line break can't be written; returns false and leaves out as it was
+    static bool appendToken(std::string &out, std::string_view value);
+
+    /// Appends a custom cvar's text to out as the rest of a set line, which is how its parser reads it back.  It can't be quoted
+    /// without the parser seeing the quotes, so text that would break the line, start a comment or expand a variable is
+    /// refused : returns false and leaves out as it was
+    static bool appendLineText(std::string &out, std::string_view value);
+
+    /// writes data to path + ".tmp" and renames it over path, so readers see the old file or the new one and never half of either
+    static bool writeFileAtomic(const std::string &path, std::string_view data);
+
+    // Snapshot file layout : a SnapshotHeader, entryCount SnapshotEntry records, historyCount SnapshotLine records, then poolSize bytes
+    // of names and text values that the records point into.  Everything is in the byte order of the machine that wrote it.
+
+    struct SnapshotHeader
+    {
+        char magic[8];             ///< "QSCSNAP"
+        std::uint32_t version;     ///< snapshotVersion
+        std::uint32_t byteOrder;   ///< snapshotByteOrder as written, so a file from a machine of the other endianness is rejected
+        std::uint32_t entrySize;   ///< sizeof(SnapshotEntry)
+        std::uint32_t entryCount;
+        std::uint32_t historyCount;
+        std::uint32_t poolSize;
+    };
+
+    struct SnapshotEntry
+    {
+        std::uint64_t bits;        ///< the value of int, float, double and bool cvars, as cvarBits()
+        SymbolID symbol;           ///< id when saved
+        std::uint32_t nameHash;    ///< SymbolTable::hash of the name
+        std::uint32_t nameOffset;  ///< into the pool
+        std::uint32_t nameLength;
+        std::uint32_t valueOffset; ///< text value in the pool, for strings, custom types and vars
+        std::uint32_t valueLength;
+        std::uint32_t flags;       ///< CVarFlags when saved
+        CVarType type;
+        std::uint8_t padding[3];
+    };
+
+    struct SnapshotLine
+    {
+        std::uint32_t offset; ///< into the pool
+        std::uint32_t length;
+    };
+
+    static constexpr std::uint32_t snapshotByteOrder = 0x01020304u;
+
+    std::string snapshotText; ///< set commands replayed by loadSnapshot(), kept to reuse its storage
+
+    std::unordered_map<SymbolID, HelpProvider> helpProviders; ///< topics whose help hasn't been made yet; see setHelpProvider()
+    std::vector<std::unique_ptr<MappedFile>> helpFiles;       ///< mapped by loadHelpFile(), and borrowed from by the help text
+
+    ///function which simply prints the value of a variable to an output stream
+    template <class T>
+    void printCvar(std::ostream &os, T *var);
+
+    ///dumps a list of available commands to the output stream
+    void listCmd(std::ostream &os);
+
+    ///dumps a list of bound cvars to the output stream
+    void listCVars(std::ostream &os);
+
+    ///dumps a list of available help topics to the output stream
+    void listHelp(std::ostream &os);
+
+    ///The function associated with the built in command "set" which parses the name of a cvar, and if it is bound, sets the value based on
+    ///the remaining arguments
+    void commandSet(ConsoleArgs &args, std::ostream &os);
+
+    ///the function associated with built in command "echo", which prints the value of a cvar if it is bound. if not, reports an error.
+    void commandEcho(ConsoleArgs &args, std::ostream &os);
+
+    ///prints help on a topic if the user types help < topic >, or a generic help message if the user just types help
+    void commandHelp(ConsoleArgs &args, std::ostream &os);
+
+    /// executes a single line: history, echo, tokenizing and dispatch.  Returns false if the line was blank or a comment
+    bool executeLine(LineScratch &scratch, std::string_view line, std::ostream &os, unsigned flags);
+
+    /// true if executeLine would run something for this line
+    static bool isExecutableLine(std::string_view line);
+
+    /// Executes a batch of lines.  forEachLine(f) calls f(line) on each line in order, stopping early if f returns false.
+    /// If rewindable, forEachLine may be called twice, so history pushes can be limited to the lines that stay in the window
+    template <class ForEachLine>
+    BatchResult runBatch(const ForEachLine &forEachLine, std::ostream &os, unsigned flags, bool rewindable = true);
+
+    /// number of errors raised so far.  See raiseError()
+    std::uint64_t errorCount = 0;
+
+    /// adds the errors raised since errorsBefore to result.  Returns false if the batch should stop
+    bool recordBatchErrors(BatchResult &result, std::uint64_t errorsBefore, std::size_t lineNumber, unsigned flags);
+
+    /// adds the time since start to the batch and writes the EXECUTE_SUMMARY line
+    void finishBatch(BatchResult &result, std::chrono::steady_clock::time_point start, std::ostream &os, unsigned flags);
+
+    /// bumped whenever a command is bound, so compiled scripts know their resolved names may be stale
+    std::uint64_t symbolsVersion = 0;
+
+    /// bumped whenever a name gains or loses a command, cvar or help topic, so completion knows what it kept from the last query may be stale
+    std::uint64_t namesVersion = 0;
+
+    SymbolID setSymbol = invalidSymbol; ///< the built in set command, which compiled scripts run inline
+    bool setRebound = false;           ///< set was replaced after construction, so compiled scripts can't run it inline
+
+    /// interns name and returns its command slot for binding, bumping symbolsVersion
+    CommandFunc &commandSlot(std::string_view name);
+
+    /// a line waiting in the submit() queue
+    struct QueuedLine
+    {
+        std::string line;
+        CompletionFunc done;
+    };
+
+    BoundedMPSCQueue<QueuedLine> queue; ///< lines from submit(), waiting for drain()
+    std::string drainOutput;            ///< output captured for completion callbacks
+
+    std::uint64_t frameNumber = 0; ///< see tick()
+
+    // set by the wait and sleep commands, and picked up by the script running them when the line ends
+    bool waitRequested = false;
+    std::uint64_t waitFrames = 0;
+    std::chrono::steady_clock::duration waitTime{};
+
+    /// asks the running script to park until frames ticks and time have passed
+    void requestWait(std::uint64_t frames, std::chrono::steady_clock::duration time);
+
+    std::vector<ScriptExecutor> waitingScripts; ///< scripts parked by wait, resumed by tick()
+    std::vector<ScriptExecutor> tickScripts;    ///< the scripts being resumed by this tick, kept to reuse its storage
+
+    std::vector<std::shared_ptr<ConsoleJob>> jobs; ///< owning thread's list of unfinished jobs
+    std::string jobOutput;                         ///< reused buffer for printing job output
+    unsigned nextJobId = 1;
+    unsigned jobThreadCount = defaultJobThreads;
+
+    // the workers' queue
+    std::vector<std::thread> jobThreads;
+    std::deque<std::shared_ptr<ConsoleJob>> jobQueue;
+    std::vector<std::shared_ptr<ConsoleJob>> runningJobs; ///< jobs a worker has taken, listed or not
+    std::mutex jobMutex;
+    std::condition_variable jobReady;
+    bool stopJobs = false;
+
+    /// a worker thread's loop
+    void jobWorker();
+
+    /// prints job output and retires finished jobs
+    void pumpJobs(std::ostream &os);
+
+    /// the jobs command
+    void commandJobs(ConsoleArgs &args, std::ostream &os);
+
+    /// one command of an alias
+    struct AliasCommand
+    {
+        std::uint32_t firstToken = 0;    ///< index into CompiledAlias::tokens
+        std::uint32_t tokenCount = 0;
+        SymbolID symbol = invalidSymbol; ///< the command's name, if it was bound when the alias was defined
+        bool raw = false;                ///< uses $, so it's tokenized when it runs
+        std::string_view text;           ///< the command as written; tokens point into this
+    };
+
+    /// an alias body, split at ; and tokenized
+    struct CompiledAlias
+    {
+        std::string body;
+        std::vector<std::string_view> tokens;
+        std::vector<AliasCommand> commands;
+    };
+
+    /// aliases by name.  shared_ptr so an alias that redefines itself while running keeps its old body until it's done.
+    /// A removed alias keeps a null entry, since its command slot can't be cleared while it runs
+    std::unordered_map<SymbolID, std::shared_ptr<const CompiledAlias>> aliases;
+
+    /// the aliases being run, innermost last, for cycle detection
+    std::vector<SymbolID> aliasStack;
+
+    /// runs the alias bound to id
+    void runAlias(SymbolID id, std::ostream &os);
+
+    /// the alias and unalias commands
+    void commandAlias(ConsoleArgs &args, std::ostream &os);
+    void commandUnalias(ConsoleArgs &args, std::ostream &os);
+
+#ifdef VIRTUOSO_CONSOLE_COROUTINES
+    /// a coroutine parked by nextFrame() or sleep()
+    struct WaitingTask
+    {
+        std::coroutine_handle<> handle;
+        std::uint64_t frame;
+        std::chrono::steady_clock::time_point time;
+    };
+
+    std::vector<WaitingTask> waitingTasks;
+    std::vector<WaitingTask> tickTasks;
+    std::ostream *tickOutput = &std::cout; ///< the stream of the tick() resuming coroutines
+#endif
+
+    /// one executable line of a compiled script
+    struct ScriptOp
+    {
+        enum Kind : std::uint8_t
+        {
+            OP_COMMAND, ///< pre-tokenized line; symbol is its first command, or invalidSymbol if that wasn't bound at compile time
+            OP_SET,     ///< set <cvar> <literal>; symbol is the cvar
+            OP_RAW      ///< has $ dereferences, so it's tokenized when it runs
+        };
+
+        Kind kind = OP_COMMAND;
+        CVarType literalType = CVAR_NONE; ///< OP_SET: type the literal was parsed as
+        std::uint32_t lineNumber = 0;     ///< zero based line in the file
+        std::uint32_t firstToken = 0;     ///< index into CompiledScript::tokens
+        std::uint32_t tokenCount = 0;
+        SymbolID symbol = invalidSymbol;
+        std::string_view line; ///< the line as written, for echo and history
+        std::string_view text; ///< the text the tokens point into
+
+        union
+        {
+            int i;
+            float f;
+            double d;
+            bool b;
+        } literal = {0};
+    };
+
+    /// a script file, tokenized and resolved against the symbol table
+    struct CompiledScript
+    {
+        std::string source;                   ///< the file contents; ops and tokens point into this
+        std::vector<std::string_view> tokens; ///< every token of every op
+        std::vector<ScriptOp> ops;
+        std::uint64_t contentHash = 0;
+        std::uint64_t symbolsVersion = 0;     ///< QuakeStyleConsole::symbolsVersion when this was compiled
+        std::filesystem::file_time_type modified;
+        std::uintmax_t size = 0;
+    };
+
+    /// compiled scripts by path.  shared_ptr so a script that is running stays alive if a nested runFile recompiles it
+    std::unordered_map<std::string, std::shared_ptr<CompiledScript>> scriptCache;
+
+    /// 64 bit FNV-1a over a file's contents
+    static std::uint64_t hashContent(std::string_view text);
+
+    /// tokenizes and resolves every line of source
+    std::shared_ptr<CompiledScript> compileScript(std::string_view source);
+
+    /// returns the compiled script for path from the cache, compiling it if it's missing or stale.  Null if the file can't be mapped
+    std::shared_ptr<CompiledScript> cachedScript(const std::string &path);
+
+    /// executes a compiled script.  If a line waits, the rest of the script is parked for tick()
+    BatchResult runCompiledScript(const std::shared_ptr<CompiledScript> &script, std::ostream &os, unsigned flags);
+
+    /// executes one line of a compiled script
+    void runScriptOp(const CompiledScript &script, const ScriptOp &op, LineScratch &scratch, std::ostream &os, unsigned lineFlags);
+
+    /// executes every command in the token stream.  Each command consumes its own arguments, and the next token names the next command
+    void executeTokens(ConsoleArgs &args, std::ostream &os);
+
+    ///creates a string variable from the console
+    void commandVar();
+
+    ///wrapper function which parses arguments to a callable taking Args... from the command's arguments then executes the function if the parsing was successful
+    ///f is taken by reference, so no function object is built or copied per call
+    template <typename... Args, typename F>
+    void parse(ConsoleArgs &args, std::ostream &os, const F &f);
+
+    ///This function is called by populateAndExecute, and only executes the bound function if the parsing succeeds
+    ///if parsing failed we do not want to pass in uninitialized garbage to the c++ function we bound
+    template <typename... Args, typename F>
+    void conditionalExecute(bool parsed, std::ostream &os, const F &f, const Args &... args);
+
+    /// adds the built-in commands to the command table
+    void bindBasicCommands();
+
+    /// helper function to return a default-constructed temp variable of a particular type.  Used in parsing arguments for C++ functions bound to the console
+    template <class T>
+    T makeTemp();
+
+    /// for parsing arguments to C++ functions bound to the console.  variadic template that recursively parses our function arguments in order.  Stops at the first failure
+    template <typename FirstType, typename... Args>
+    bool populateTemps(ConsoleArgs &args, FirstType &in, Args &... Temps);
+
+    /// for parsing arguments to C++ functions bound to the console. variadic template that recursively parses our function arguments in order.  base case
+    template <typename FirstType>
+    bool populateTemps(ConsoleArgs &args, FirstType &in);
+
+    /// for parsing arguments to C++ functions bound to the console. variadic template that recursively parses our function arguments in order.  base case
+    bool populateTemps(ConsoleArgs &) { return true; }
+
+    /// for parsing arguments to C++ functions bound to the console.  call starts populating temp variables
+    template <typename... Args>
+    bool goPopulateTemps(ConsoleArgs &args, Args &... temps);
+
+    /// for parsing arguments to C++ functions bound to the console.  Populates the temp variables from the arguments, then calls the function with them
+    template <typename... Args, typename F>
+    void populateAndExecute(ConsoleArgs &args, std::ostream &os, const F &f,
+                            typename std::remove_const<typename std::remove_reference<Args>::type>::type... temps);
+
+    /// splits a line into tokens, replacing $identifiers with the value of the variable in the same pass.  Results go in scratch
+    void tokenizeLine(std::string_view line, LineScratch &scratch, std::ostream &os);
+
+    /// appends the value of the variable named by identifier to scratch.expanded, and adds its tokens.  Returns false if there was no such variable
+    bool expandVariable(std::string_view identifier, LineScratch &scratch, std::ostream &os);
+
+    /// assigns the value of a dynamically created console variable from the command's arguments
+    template <class T>
+    bool assignDynamicVariable(ConsoleArgs &args, std::shared_ptr<T> var);
+
+    /// writes a dynamically created console variable to the console output
+    template <class T>
+    void writeDynamicVariable(std::ostream &os, std::shared_ptr<T> var);
+
+    /// bind dynamically created console variable to the variable table and set the associated help string
+    template <class T>
+    void bindDynamicCVar(const std::string &var, const T &value, HelpText help);
+
+    /// bind dynamically created console variable to the variable table.
+    template <class T>
+    void bindDynamicCVar(const std::string &var, const T &valueIn);
+
+  public:
+    /// Dynamic variables are string-based variables that can be created, assigned, and dereferenced from the console itself rather than C++ code
+    struct DynamicVariable : public std::string
+    {
+    };
+
+    // -----------------------------------------------------------------------------
+    // EndOfLineEscapeStreamScope : by Steve132
+    // For wrapping the output of an ostream push sequence << in a begin / end tag
+    // Used for console output formatting
+    // -----------------------------------------------------------------------------
+    typedef std::pair<std::string, std::string> EndOfLineEscapeTag;
+
+    struct EndOfLineEscapeStreamScope
+    {
+      protected:
+        const EndOfLineEscapeTag &tag; ///< the tag outlives the scope, which ends with the << expression it was made in
+        std::ostream &os;
+
+        EndOfLineEscapeStreamScope(const EndOfLineEscapeTag &ttag, std::ostream &tout) : tag(ttag),
+                                                                                         os(tout)
+        {
+            os << tag.first; //you can overload this for custom ostream types with a different color interface
+            //this might also have a stack interface for if you need multiple resets
+        }
+
+        friend EndOfLineEscapeStreamScope operator<<(std::ostream &out, const EndOfLineEscapeTag &tg);
+
+      public:
+        template <class T>
+        EndOfLineEscapeStreamScope &operator<<(T &&t)
+        {
+            os << std::forward<T>(t);
+            return *this;
+        }
+
+        EndOfLineEscapeStreamScope &operator<<(std::ostream &(&M)(std::ostream &))
+        {
+            M(os);
+            return *this;
+        }
+
+        ~EndOfLineEscapeStreamScope()
+        {
+            os << tag.second;
+        }
+    };
+};
+
+/// A script that runs a slice at a time.  Keep it around and call step() once per frame until it returns false.
+/// It holds a pointer to the console that made it, so the console must outlive it.
+class QuakeStyleConsole::ScriptExecutor
+{
+  public:
+    ScriptExecutor() = default;
+
+    /// Runs lines until maxLines have run or timeBudget has passed, whichever comes first.  At least one line runs per call,
+    /// so a script always makes progress.  Capping only maxLines gives the same work every frame.  Returns true while lines remain
+    bool step(std::ostream &os, std::size_t maxLines, std::chrono::microseconds timeBudget = std::chrono::microseconds::max());
+
+    /// runs lines until timeBudget has passed
+    bool step(std::ostream &os, std::chrono::microseconds timeBudget) { return step(os, std::numeric_limits<std::size_t>::max(), timeBudget); }
+
+    /// stops the script; the remaining lines won't run
+    void cancel() { cancelled = true; }
+
+    /// true once every line has run, or the script was cancelled or stopped on an error
+    bool done() const { return !script || cancelled || batch.stopped || (next >= script->ops.size() && nested.empty()); }
+
+    /// true while the script is paused by wait or sleep, or by a script it ran that is.  step() does nothing until the console's tick() has moved past it
+    bool waiting() const;
+
+    bool wasCancelled() const { return cancelled; }
+
+    /// lines run so far
+    std::size_t linesRun() const { return batch.lines; }
+
+    /// executable lines in the script, not counting blank lines and comments
+    std::size_t lineCount() const { return script ? script->ops.size() : 0; }
+
+    /// fraction of the script that has run, 0 to 1
+    float progress() const { return lineCount() ? float(next) / float(lineCount()) : 1.0f; }
+
+    /// the totals so far.  seconds only counts time spent in step()
+    const BatchResult &result() const { return batch; }
+
+  private:
+    friend class QuakeStyleConsole;
+
+    ScriptExecutor(QuakeStyleConsole &con, std::shared_ptr<const CompiledScript> compiled, unsigned executeFlags, std::size_t first = 0);
+
+    /// takes the scripts a runFile on the last line parked from firstParked on, to finish before this one goes on.
+    /// If there are none, takes the console's pending wait as this script's resume point
+    void parkOnWait(std::size_t firstParked);
+
+    QuakeStyleConsole *console = nullptr;
+    std::shared_ptr<const CompiledScript> script; ///< shared with the cache, so a recompile doesn't pull it out from under us
+    std::size_t next = 0;                         ///< index of the next op to run
+    std::size_t historySkip = 0;                  ///< lines before this one aren't pushed to history, since they'd scroll out anyway
+    unsigned flags = 0;
+    bool cancelled = false;
+    BatchResult batch;
+    std::vector<ScriptExecutor> nested; ///< the waiting rest of scripts this one ran, in order
+
+    std::uint64_t resumeFrame = 0;                  ///< doesn't run before this tick
+    std::chrono::steady_clock::time_point resumeTime; ///< or before this time
+};
+
+inline Virtuoso::QuakeStyleConsole::EndOfLineEscapeStreamScope operator<<(std::ostream &os, const Virtuoso::QuakeStyleConsole::EndOfLineEscapeTag &tg)
+{
+    return Virtuoso::QuakeStyleConsole::EndOfLineEscapeStreamScope(tg, os);
+}
+
+/// dynamic variables take the rest of the line
+template <>
+struct ConsoleArgParser<QuakeStyleConsole::DynamicVariable>
+{
+    static bool parse(ConsoleArgs &args, QuakeStyleConsole::DynamicVariable &value);
+};
+
+} // namespace Virtuoso
+
+// -----------------------------------------------------------------------------
+// Argument parsing helpers : Method Implementations below
+// -----------------------------------------------------------------------------
+
+inline Virtuoso::ViewStreamBuf::ViewStreamBuf(std::string_view view)
+{
+    char *b = const_cast<char *>(view.data()); // the get area is never written through
+    setg(b, b, b + view.size());
+}
+
+inline Virtuoso::ViewStreamBuf::pos_type Virtuoso::ViewStreamBuf::seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which)
+{
+    if (!(which & std::ios_base::in))
+    {
+        return pos_type(off_type(-1));
+    }
+
+    off_type base = 0;
+
+    if (dir == std::ios_base::cur)
+    {
+        base = gptr() - eback();
+    }
+    else if (dir == std::ios_base::end)
+    {
+        base = egptr() - eback();
+    }
+
+    const off_type target = base + off;
+
+    if (target < 0 || target > egptr() - eback())
+    {
+        return pos_type(off_type(-1));
+    }
+
+    setg(eback(), eback() + target, egptr());
+    return pos_type(target);
+}
+
+inline Virtuoso::ViewStreamBuf::pos_type Virtuoso::ViewStreamBuf::seekpos(pos_type pos, std::ios_base::openmode which)
+{
+    return seekoff(off_type(pos), std::ios_base::beg, which);
+}
+
+inline Virtuoso::StringAppendBuf::int_type Virtuoso::StringAppendBuf::overflow(int_type c)
+{
+    if (c != traits_type::eof())
+    {
+        str.push_back(traits_type::to_char_type(c));
+    }
+    return traits_type::not_eof(c);
+}
+
+inline std::streamsize Virtuoso::StringAppendBuf::xsputn(const char *s, std::streamsize n)
+{
+    str.append(s, static_cast<std::size_t>(n));
+    return n;
+}
+
+inline bool Virtuoso::MappedFile::open(const std::string &path)
+{
+    close();
+
+#if defined(VIRTUOSO_CONSOLE_WIN32_MMAP)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+
+    if (GetFileType(file) != FILE_TYPE_DISK || !GetFileSizeEx(file, &size))
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    if (size.QuadPart == 0) // can't map an empty file, but there's nothing to read anyway
+    {
+        CloseHandle(file);
+        opened = true;
+        return true;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+
+    if (!mapping)
+    {
+        return false;
+    }
+
+    const void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping); // the view keeps the mapping alive
+
+    if (!view)
+    {
+        return false;
+    }
+
+    data = static_cast<const char *>(view);
+    length = std::size_t(size.QuadPart);
+    opened = true;
+    return true;
+
+#elif defined(VIRTUOSO_CONSOLE_POSIX_MMAP)
+    const int fd = ::open(path.c_str(), O_RDONLY);
+
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat st;
+
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+    {
+        ::close(fd);
+        return false;
+    }
+
+    if (st.st_size == 0) // can't map an empty file, but there's nothing to read anyway
+    {
+        ::close(fd);
+        opened = true;
+        return true;
+    }
+
+    void *view = mmap(nullptr, std::size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping keeps the file alive
+
+    if (view == MAP_FAILED)
+    {
+        return false;
+    }
+
+#ifdef MADV_SEQUENTIAL
+    madvise(view, std::size_t(st.st_size), MADV_SEQUENTIAL);
+#endif
+
+    data = static_cast<const char *>(view);
+    length = std::size_t(st.st_size);
+    opened = true;
+    return true;
+
+#else
+    std::error_code ec;
+
+    if (!std::filesystem::is_regular_file(path, ec))
+    {
+        return false;
+    }
+
+    std::ifstream in(path, std::ios::binary);
+
+    if (!in)
+    {
+        return false;
+    }
+
+    contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+
+    if (in.bad())
+    {
+        contents.clear();
+        return false;
+    }
+
+    data = contents.data();
+    length = contents.size();
+    opened = true;
+    return true;
+#endif
+}
+
+inline void Virtuoso::MappedFile::close()
+{
+    if (data)
+    {
+#if defined(VIRTUOSO_CONSOLE_WIN32_MMAP)
+        UnmapViewOfFile(data);
+#elif defined(VIRTUOSO_CONSOLE_POSIX_MMAP)
+        munmap(const_cast<char *>(data), length);
+#else
+        std::string().swap(contents);
+#endif
+    }
+
+    data = nullptr;
+    length = 0;
+    opened = false;
+}
+
+inline bool Virtuoso::ConsoleArgs::next(std::string_view &tok)
+{
+    if (empty())
+    {
+        return false;
+    }
+
+    tok = tokens[pos++];
+    return true;
+}
+
+inline std::string_view Virtuoso::ConsoleArgs::rest() const
+{
+    if (empty())
+    {
+        return std::string_view();
+    }
+
+    const std::size_t offset = static_cast<std::size_t>(tokens[pos].data() - text.data());
+    return text.substr(offset);
+}
+
+inline void Virtuoso::ConsoleArgs::consume(std::size_t n)
+{
+    if (empty())
+    {
+        return;
+    }
+
+    const char *boundary = tokens[pos].data() + n;
+
+    while (pos < count && tokens[pos].data() < boundary)
+    {
+        pos++;
+    }
+}
+
+template <class F>
+inline bool Virtuoso::ConsoleArgs::parseStream(F &&f)
+{
+    ViewIStream is(rest());
+
+    f(static_cast<std::istream &>(is));
+
+    consume(is.consumed());
+
+    return !is.fail();
+}
+
+template <class T>
+inline bool Virtuoso::parseConsoleNumber(std::string_view token, T &value)
+{
+    if (token.size() > 1 && token[0] == '+')
+    {
+        token.remove_prefix(1);
+    }
+
+    const char *end = token.data() + token.size();
+
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    std::from_chars_result result = std::from_chars(token.data(), end, value);
+    return result.ec == std::errc() && result.ptr == end;
+#else
+    if constexpr (std::is_integral<T>::value)
+    {
+        std::from_chars_result result = std::from_chars(token.data(), end, value);
+        return result.ec == std::errc() && result.ptr == end;
+    }
+    else
+    {
+        // no floating point from_chars in this standard library.  strtod needs a terminator, so copy to the stack
+        char buf[64];
+
+        if (token.size() >= sizeof(buf))
+        {
+            return false;
+        }
+
+        token.copy(buf, token.size());
+        buf[token.size()] = '\0';
+
+        char *parsedEnd = nullptr;
+        const long double parsed = std::strtold(buf, &parsedEnd);
+
+        if (parsedEnd != buf + token.size())
+        {
+            return false;
+        }
+
+        value = static_cast<T>(parsed);
+        return true;
+    }
+#endif
+}
+
+template <class T>
+inline bool Virtuoso::ConsoleArgParser<T, typename std::enable_if<Virtuoso::IsConsoleInteger<T>::value || std::is_floating_point<T>::value>::type>::parse(ConsoleArgs &args, T &value)
+{
+    T tmp;
+
+    if (!parseConsoleNumber(args.peek(), tmp))
+    {
+        return false;
+    }
+
+    args.next();
+    value = tmp;
+    return true;
+}
+
+inline bool Virtuoso::ConsoleArgParser<bool>::parse(ConsoleArgs &args, bool &value)
+{
+    const std::string_view token = args.peek();
+
+    for (const ConsoleBoolName &b : consoleBoolNames)
+    {
+        if (b.name.size() == token.size() &&
+            std::equal(token.begin(), token.end(), b.name.begin(), [](char x, char y) { return std::tolower(static_cast<unsigned char>(x)) == y; }))
+        {
+            value = b.value;
+            args.next();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+inline std::string_view Virtuoso::unquoteToken(std::string_view token)
+{
+    if (token.size() && token[0] == '"')
+    {
+        token.remove_prefix(1);
+
+        if (token.size() && token.back() == '"')
+        {
+            token.remove_suffix(1);
+        }
+    }
+
+    return token;
+}
+
+inline bool Virtuoso::ConsoleArgParser<std::string>::parse(ConsoleArgs &args, std::string &value)
+{
+    if (args.empty())
+    {
+        return false;
+    }
+
+    const std::string_view token = unquoteToken(args.next());
+    value.assign(token.data(), token.size());
+    return true;
+}
+
+inline bool Virtuoso::ConsoleArgParser<std::string_view>::parse(ConsoleArgs &args, std::string_view &value)
+{
+    if (args.empty())
+    {
+        return false;
+    }
+
+    value = unquoteToken(args.next());
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// QuakeStyleConsole : Method Implementations below
+// -----------------------------------------------------------------------------
+
+template <class T>
+inline T Virtuoso::QuakeStyleConsole::makeTemp()
+{
+    T temp{};
+    return temp;
+}
+
+template <typename... Args, typename F>
+inline void Virtuoso::QuakeStyleConsole::conditionalExecute(bool parsed, std::ostream &os, const F &f, const Args &... args)
+{
+    if (!parsed)
+    {
+        raiseError(os) << "Syntax error in function arguments." << std::endl;
+    }
+    else
+    {
+        f(args...);
+    }
+}
+
+template <typename FirstType>
+inline bool Virtuoso::QuakeStyleConsole::populateTemps(ConsoleArgs &args, FirstType &in)
+{
+    return ConsoleArgParser<FirstType>::parse(args, in);
+}
+
+//variadic template that recursively parses our function arguments in order
+template <typename FirstType, typename... Args>
+inline bool Virtuoso::QuakeStyleConsole::populateTemps(ConsoleArgs &args, FirstType &in, Args &... Temps)
+{
+    return ConsoleArgParser<FirstType>::parse(args, in) && populateTemps(args, Temps...);
+}
+
+template <typename... Args>
+inline bool Virtuoso::QuakeStyleConsole::goPopulateTemps(ConsoleArgs &args, Args &... temps)
+{
+    return populateTemps(args, temps...);
+}
+
+template <typename... Args, typename F>
+inline void Virtuoso::QuakeStyleConsole::populateAndExecute(ConsoleArgs &args, std::ostream &os, const F &f,
+                                                            typename std::remove_const<typename std::remove_reference<Args>::type>::type... temps)
+{
+    bool parsed = goPopulateTemps<typename std::remove_const<typename std::remove_reference<Args>::type>::type...>(args, temps...);
+
+    conditionalExecute<Args...>(parsed, os, f, temps...);
+}
+
+//function that gets bound as type void to the console with a second function object that may have multiple arguments of various types
+//this function gets called when the user enters the function name into the console.
+template <typename... Args, typename F>
+inline void Virtuoso::QuakeStyleConsole::parse(ConsoleArgs &args, std::ostream &os, const F &f)
+{
+
+    //first we have to create a bunch of temp variables and pass them into the populateAndExecute function
+    //the temp variables are needed to store the result.  There's no guarantee in c++ for argument evaluation order, so we can't just
+    //skip the intermediate step of passing constructed temps into a second function
+    populateAndExecute<Args...>(args, os, f, (makeTemp<typename std::remove_const<typename std::remove_reference<Args>::type>::type>())...);
+}
+
+inline void Virtuoso::QuakeStyleConsole::bindCommand(const std::string &str, void (*fptr)(void), HelpText help)
+{
+    commandSlot(str) = [fptr](ConsoleArgs &, std::ostream &) { fptr(); };
+
+    if (!help.empty())
+        setHelpTopic(str, std::move(help));
+}
+
+template <typename... Args>
+inline void Virtuoso::QuakeStyleConsole::bindCommand(const std::string &str, void (*fptr)(Args...), HelpText help)
+{
+    commandSlot(str) =
+        [this, fptr](ConsoleArgs &args, std::ostream &os) {
+            this->parse<Args...>(args, os, fptr);
+        };
+
+    if (!help.empty())
+        setHelpTopic(str, std::move(help));
+}
+
+template <typename... Args>
+inline void Virtuoso::QuakeStyleConsole::bindCommand(const std::string &str, std::function<void(Args...)> fun, HelpText help)
+{
+    commandSlot(str) =
+        [this, fun](ConsoleArgs &args, std::ostream &os) {
+            this->parse<Args...>(args, os, fun);
+        };
+
+    if (!help.empty())
+        setHelpTopic(str, std::move(help));
+}
+
+inline void Virtuoso::QuakeStyleConsole::bindCommand(const std::string &str, ConsoleFunc fun, HelpText help)
+{
+    bindCommand(str,
+                CommandFunc([fun](ConsoleArgs &args, std::ostream &os) {
+                    args.parseStream([&](std::istream &is) { fun(is, os); });
+                }),
+                std::move(help));
+}
+
+inline void Virtuoso::QuakeStyleConsole::bindCommand(const std::string &str, CommandFunc fun, HelpText help)
+{
+    if (!help.empty())
+        setHelpTopic(str, std::move(help));
+
+    commandSlot(str) = fun;
+}
+
+inline void Virtuoso::QuakeStyleConsole::setHelpTopic(const std::string &str, HelpText data)
+{
+    const SymbolID id = symbols.intern(str);
+
+    if (helpProviders.size())
+    {
+        helpProviders.erase(id);
+    }
+
+    symbols[id].help = std::move(data);
+    namesVersion++;
+}
+
+inline void Virtuoso::QuakeStyleConsole::setHelpProvider(const std::string &topic, HelpProvider provider)
+{
+    const SymbolID id = symbols.intern(topic);
+
+    HelpText &help = symbols[id].help;
+    help = HelpText();
+    help.deferred = true;
+    namesVersion++;
+
+    helpProviders[id] = std::move(provider);
+}
+
+inline bool Virtuoso::QuakeStyleConsole::loadHelpFile(const std::string &path)
+{
+    std::unique_ptr<MappedFile> file(new MappedFile(path));
+
+    if (!file->isOpen())
+    {
+        return false;
+    }
+
+    const std::string_view text = file->view();
+
+    std::string_view topic;
+    std::size_t bodyStart = 0;
+
+    // the body of the current topic runs up to the next @ line
+    auto finishTopic = [&](std::size_t bodyEnd) {
+        std::string_view body = text.substr(bodyStart, bodyEnd - bodyStart);
+
+        while (body.size() && isConsoleSpace(body.back()))
+        {
+            body.remove_suffix(1);
+        }
+
+        if (topic.size())
+        {
+            setHelpTopic(std::string(topic), HelpText::borrow(body));
+        }
+    };
+
+    for (std::size_t pos = 0; pos < text.size();)
+    {
+        std::size_t end = text.find('\n', pos);
+        end = (end == text.npos) ? text.size() : end;
+
+        if (text[pos] == '@')
+        {
+            finishTopic(pos);
+
+            topic = text.substr(pos + 1, end - pos - 1);
+
+            while (topic.size() && isConsoleSpace(topic.back()))
+            {
+                topic.remove_suffix(1);
+            }
+
+            bodyStart = std::min(end + 1, text.size());
+        }
+
+        pos = end + 1;
+    }
+
+    finishTopic(text.size());
+
+    helpFiles.push_back(std::move(file));
+
+    return true;
+}
+
+inline std::string_view Virtuoso::QuakeStyleConsole::helpText(std::string_view topic)
+{
+    const SymbolID id = symbols.find(topic);
+
+    if (id != invalidSymbol)
+    {
+        HelpText &help = symbols[id].help;
+
+        if (help.deferred)
+        {
+            auto it = helpProviders.find(id);
+
+            if (it != helpProviders.end())
+            {
+                const std::string text = it->second(symbols[id].name);
+                helpProviders.erase(it);
+                help.assign(text);
+            }
+
+            help.deferred = false;
+
+            if (help.empty())
+            {
+                namesVersion++; // nothing to say after all, so it's no longer a help topic
+            }
+        }
+
+        if (help.length())
+        {
+            return help.view();
+        }
+    }
+
+    if (const StaticSymbol *s = StaticSymbolRegistry::find(topic))
+    {
+        return s->help;
+    }
+
+    return std::string_view();
+}
+
+inline Virtuoso::QuakeStyleConsole::HelpStats Virtuoso::QuakeStyleConsole::helpStats() const
+{
+    HelpStats stats;
+
+    for (const Symbol &symbol : symbols.all())
+    {
+        const HelpText &help = symbol.help;
+
+        if (help.empty())
+        {
+            continue;
+        }
+
+        stats.topics++;
+        stats.lazyTopics += help.lazy();
+
+        if (help.copied())
+        {
+            stats.copiedBytes += help.length();
+            stats.copies++;
+        }
+        else
+        {
+            stats.borrowedBytes += help.length();
+        }
+    }
+
+    return stats;
+}
+
+inline Virtuoso::HelpText &Virtuoso::HelpText::operator=(const HelpText &other)
+{
+    if (this != &other)
+    {
+        if (other.owned)
+        {
+            assign(other.text);
+        }
+        else
+        {
+            owned.reset();
+            text = other.text;
+        }
+
+        deferred = other.deferred;
+    }
+
+    return *this;
+}
+
+inline Virtuoso::HelpText Virtuoso::HelpText::borrow(std::string_view text)
+{
+    HelpText help;
+    help.text = text;
+    return help;
+}
+
+inline void Virtuoso::HelpText::assign(std::string_view s)
+{
+    owned.reset();
+    text = std::string_view();
+    deferred = false;
+
+    if (s.size())
+    {
+        owned.reset(new char[s.size()]);
+        std::memcpy(owned.get(), s.data(), s.size());
+        text = std::string_view(owned.get(), s.size());
+    }
+}
+
+template <class T>
+inline void Virtuoso::QuakeStyleConsole::bindCVar(const std::string &str, T &var, HelpText help, unsigned flags)
+{
+    const SymbolID id = symbols.intern(str);
+    CVar &cvar = symbols[id].cvar;
+
+    cvar.type = CVarTypeOf<T>::value;
+    cvar.flags = flags;
+    cvar.version++;
+    cvar.symbol = id;
+    cvar.saved = false;
+    refreshWatchModes(cvar);
+    namesVersion++;
+
+    if ((flags & CVAR_ARCHIVE) && std::find(archivedCVars.begin(), archivedCVars.end(), id) == archivedCVars.end())
+    {
+        archivedCVars.push_back(id);
+        archivedLines.emplace_back();
+    }
+
+    if constexpr (CVarTypeOf<T>::value == CVAR_CUSTOM)
+    {
+        cvar.data = nullptr;
+
+        cvar.read =
+            [this, &var](ConsoleArgs &args, std::ostream &os) {
+                return this->setCvar<T>(args, os, &var);
+            };
+
+        cvar.print =
+            [this, &var](std::ostream &os) {
+                this->printCvar<T>(os, &var);
+            };
+    }
+    else
+    {
+        cvar.data = &var;
+        cvar.read = nullptr;
+        cvar.print = nullptr;
+    }
+
+    if (!help.empty())
+        setHelpTopic(str, std::move(help));
+}
+
+template <class T>
+bool Virtuoso::QuakeStyleConsole::setCvar(ConsoleArgs &args, std::ostream &os, T *var)
+{
+    T tmp; ///temp argument is a necessity; without it we risk corruption of our variable value if there is a parse error.  Should be no issue unless someone is using this to parse a ginormous structure or copy construction invokes a state change.
+
+    if (!ConsoleArgParser<T>::parse(args, tmp))
+    {
+        raiseError(os) << "SYNTAX ERROR IN VARIABLE PARSER" << std::endl;
+        return false;
+    }
+
+    *var = tmp;
+    return true;
+}
+
+inline Virtuoso::QuakeStyleConsole::CVar *Virtuoso::QuakeStyleConsole::lookupCVar(std::string_view name)
+{
+    SymbolID id = symbols.find(name);
+
+    if ((id == invalidSymbol || !symbols[id].cvar) && mergedStaticHead != StaticSymbolRegistry::head)
+    {
+        // static cvars are merged on first use, so they get a record and a version like any other
+        mergeStaticSymbols();
+        id = symbols.find(name);
+    }
+
+    return (id != invalidSymbol && symbols[id].cvar) ? &symbols[id].cvar : nullptr;
+}
+
+inline bool Virtuoso::QuakeStyleConsole::readCVar(CVar &cvar, ConsoleArgs &args, std::ostream &os)
+{
+    bool parsed = false;
+
+    switch (cvar.type)
+    {
+    case CVAR_INT:
+        parsed = setCvar(args, os, static_cast<int *>(cvar.data));
+        break;
+    case CVAR_FLOAT:
+        parsed = setCvar(args, os, static_cast<float *>(cvar.data));
+        break;
+    case CVAR_DOUBLE:
+        parsed = setCvar(args, os, static_cast<double *>(cvar.data));
+        break;
+    case CVAR_BOOL:
+        parsed = setCvar(args, os, static_cast<bool *>(cvar.data));
+        break;
+    case CVAR_STRING:
+        parsed = setCvar(args, os, static_cast<std::string *>(cvar.data));
+        break;
+    case CVAR_CUSTOM:
+        parsed = cvar.read(args, os);
+        break;
+    case CVAR_NONE:
+        break;
+    }
+
+    if (parsed)
+    {
+        cvarChanged(cvar);
+    }
+
+    return parsed;
+}
+
+inline void Virtuoso::QuakeStyleConsole::writeCVar(const CVar &cvar, std::ostream &os)
+{
+    switch (cvar.type)
+    {
+    case CVAR_INT:
+        printCvar(os, static_cast<int *>(cvar.data));
+        break;
+    case CVAR_FLOAT:
+        printCvar(os, static_cast<float *>(cvar.data));
+        break;
+    case CVAR_DOUBLE:
+        printCvar(os, static_cast<double *>(cvar.data));
+        break;
+    case CVAR_BOOL:
+        printCvar(os, static_cast<bool *>(cvar.data));
+        break;
+    case CVAR_STRING:
+        printCvar(os, static_cast<std::string *>(cvar.data));
+        break;
+    case CVAR_CUSTOM:
+        cvar.print(os);
+        break;
+    case CVAR_NONE:
+        break;
+    }
+}
+
+inline void Virtuoso::QuakeStyleConsole::cvarChanged(CVar &cvar)
+{
+    cvar.version++;
+
+    if (loadingConfig && (cvar.flags & CVAR_ARCHIVE))
+    {
+        markCVarSaved(cvar);
+    }
+
+    if (!cvar.watchModes)
+    {
+        return;
+    }
+
+    if ((cvar.watchModes & WATCH_COALESCED) && !cvar.changePending)
+    {
+        cvar.changePending = true;
+        changedCVars.push_back(cvar.symbol);
+    }
+
+    if (cvar.watchModes & WATCH_IMMEDIATE)
+    {
+        callWatchers(cvar, WATCH_IMMEDIATE);
+    }
+}
+
+inline bool Virtuoso::QuakeStyleConsole::watcherMatches(const CVarWatcher &w, SymbolID symbol) const
+{
+    if (!w.func)
+    {
+        return false;
+    }
+
+    return w.prefix ? (symbols[symbol].name.substr(0, w.name.size()) == w.name) : (w.symbol == symbol);
+}
+
+inline std::size_t Virtuoso::QuakeStyleConsole::callWatchers(CVar &cvar, WatchMode mode)
+{
+    std::size_t called = 0;
+
+    watchDepth++;
+
+    // by index : a watcher can add watchers, which only ever go on the end
+    for (std::size_t i = 0; i < watchers.size(); i++)
+    {
+        const CVarWatcher &w = watchers[i];
+
+        if ((w.mode & mode) && watcherMatches(w, cvar.symbol))
+        {
+            w.func(symbols[cvar.symbol].name, cvar);
+            called++;
+        }
+    }
+
+    if (--watchDepth == 0)
+    {
+        watchers.erase(std::remove_if(watchers.begin(), watchers.end(), [](const CVarWatcher &w) { return !w.func; }), watchers.end());
+    }
+
+    return called;
+}
+
+inline void Virtuoso::QuakeStyleConsole::refreshWatchModes(CVar &cvar)
+{
+    cvar.watchModes = 0;
+
+    for (const CVarWatcher &w : watchers)
+    {
+        if (watcherMatches(w, cvar.symbol))
+        {
+            cvar.watchModes |= w.mode;
+        }
+    }
+}
+
+inline void Virtuoso::QuakeStyleConsole::refreshWatchModes()
+{
+    for (SymbolID id = 0; id < symbols.size(); id++)
+    {
+        if (symbols[id].cvar)
+        {
+            refreshWatchModes(symbols[id].cvar);
+        }
+    }
+}
+
+inline Virtuoso::QuakeStyleConsole::WatchID Virtuoso::QuakeStyleConsole::addWatcher(CVarWatcher w)
+{
+    w.id = nextWatchID++;
+    watchers.push_back(std::move(w));
+
+    refreshWatchModes();
+
+    return watchers.back().id;
+}
+
+inline Virtuoso::QuakeStyleConsole::WatchID Virtuoso::QuakeStyleConsole::watchCVar(std::string_view name, CVarWatchFunc f, WatchMode mode)
+{
+    return addWatcher({0, mode, false, symbols.intern(name), std::string(), std::move(f)});
+}
+
+inline Virtuoso::QuakeStyleConsole::WatchID Virtuoso::QuakeStyleConsole::watchCVarPrefix(std::string_view prefix, CVarWatchFunc f, WatchMode mode)
+{
+    return addWatcher({0, mode, true, invalidSymbol, std::string(prefix), std::move(f)});
+}
+
+inline void Virtuoso::QuakeStyleConsole::unwatchCVar(WatchID id)
+{
+    for (CVarWatcher &w : watchers)
+    {
+        if (w.id == id)
+        {
+            w.func = nullptr; // erased once no watcher is running
+        }
+    }
+
+    if (watchDepth == 0)
+    {
+        watchers.erase(std::remove_if(watchers.begin(), watchers.end(), [](const CVarWatcher &w) { return !w.func; }), watchers.end());
+    }
+
+    refreshWatchModes();
+}
+
+inline std::size_t Virtuoso::QuakeStyleConsole::dispatchChanges()
+{
+    std::size_t called = 0;
+
+    // a watcher that sets cvars queues them for the next dispatch, rather than looping here
+    dispatchList.swap(changedCVars);
+
+    for (SymbolID id : dispatchList)
+    {
+        CVar &cvar = symbols[id].cvar;
+        cvar.changePending = false;
+        called += callWatchers(cvar, WATCH_COALESCED);
+    }
+
+    dispatchList.clear();
+
+    return called;
+}
+
+inline std::uint64_t Virtuoso::QuakeStyleConsole::cvarBits(const CVar &cvar) const
+{
+    std::uint64_t bits = 0;
+
+    switch (cvar.type)
+    {
+    case CVAR_INT:
+        std::memcpy(&bits, cvar.data, sizeof(int));
+        break;
+    case CVAR_FLOAT:
+        std::memcpy(&bits, cvar.data, sizeof(float));
+        break;
+    case CVAR_DOUBLE:
+        std::memcpy(&bits, cvar.data, sizeof(double));
+        break;
+    case CVAR_BOOL:
+        bits = *static_cast<const bool *>(cvar.data);
+        break;
+    case CVAR_STRING:
+        bits = hashContent(*static_cast<const std::string *>(cvar.data));
+        break;
+    default:
+        bits = cvar.version;
+        break;
+    }
+
+    return bits;
+}
+
+inline bool Virtuoso::QuakeStyleConsole::cvarUnsaved(const CVar &cvar) const
+{
+    return !cvar.saved || cvar.savedVersion != cvar.version || cvar.savedBits != cvarBits(cvar);
+}
+
+inline void Virtuoso::QuakeStyleConsole::markCVarSaved(CVar &cvar)
+{
+    cvar.saved = true;
+    cvar.savedVersion = cvar.version;
+    cvar.savedBits = cvarBits(cvar);
+}
+
+inline std::size_t Virtuoso::QuakeStyleConsole::unsavedCVarCount()
+{
+    std::size_t count = 0;
+
+    for (SymbolID id : archivedCVars)
+    {
+        const CVar &cvar = symbols[id].cvar;
+        count += (cvar.flags & CVAR_ARCHIVE) && cvarUnsaved(cvar);
+    }
+
+    return count;
+}
+
+inline Virtuoso::QuakeStyleConsole::SaveResult Virtuoso::QuakeStyleConsole::saveConfig(const std::string &path, bool force)
+{
+    // a file that can't be checked counts as changed, so the write gets to report the failure
+    std::error_code ec;
+    const bool exists = std::filesystem::exists(path, ec);
+    bool changed = force || path != lastConfigPath || ec || !exists;
+
+    // one look at each value : whether it differs from what was saved, and whether the line written for it last time still holds.
+    // Lines that don't are marked for formatting, with the value they'll be formatted from
+    for (std::size_t i = 0; i < archivedCVars.size(); i++)
+    {
+        const CVar &cvar = symbols[archivedCVars[i]].cvar;
+        ArchivedLine &line = archivedLines[i];
+
+        line.written = (cvar.flags & CVAR_ARCHIVE) && !(cvar.flags & CVAR_READONLY);
+
+        if (!(cvar.flags & CVAR_ARCHIVE))
+        {
+            continue;
+        }
+
+        const std::uint64_t bits = cvarBits(cvar);
+
+        if (line.bits != bits || line.version != cvar.version)
+        {
+            line.valid = false;
+            line.rejected = false;
+        }
+
+        line.bits = bits;
+        line.version = cvar.version;
+
+        // a value that was already turned down doesn't make every later save rewrite the file
+        changed = changed || ((!cvar.saved || cvar.savedVersion != cvar.version || cvar.savedBits != bits) && !line.rejected);
+    }
+
+    if (!changed)
+    {
+        return SAVE_SKIPPED;
+    }
+
+    // only the marked lines are formatted; the rest are copied as they were.  Values come from the $ cache, except floating
+    // point, which is written exactly instead
+    configText.assign("# archived cvars, written by saveConfig\n");
+
+    for (std::size_t i = 0; i < archivedCVars.size(); i++)
+    {
+        ArchivedLine &line = archivedLines[i];
+
+        if (!line.written)
+        {
+            continue;
+        }
+
+        if (!line.valid && !line.rejected)
+        {
+            const SymbolID id = archivedCVars[i];
+            const CVar &cvar = symbols[id].cvar;
+
+            char numberBuf[40];
+
+            std::string_view value;
+
+            if (cvar.type == CVAR_FLOAT)
+            {
+                value = exactNumberText(CVAR_FLOAT, *static_cast<const float *>(cvar.data), numberBuf);
+            }
+            else if (cvar.type == CVAR_DOUBLE)
+            {
+                value = exactNumberText(CVAR_DOUBLE, *static_cast<const double *>(cvar.data), numberBuf);
+            }
+            else if (cvar.type == CVAR_STRING)
+            {
+                value = *static_cast<const std::string *>(cvar.data); // cvarText trims trailing spaces, which have to be kept
+            }
+            else
+            {
+                value = cvarText(cvar);
+            }
+
+            const std::size_t lineStart = configText.size();
+
+            configText.append("set ").append(symbols[id].name).append(" ");
+
+            // strings have to stay one token, and other types' text has to reach their parsers as it was printed
+            bool written = true;
+
+            if (cvar.type == CVAR_STRING)
+            {
+                written = appendToken(configText, value);
+            }
+            else if (cvar.type == CVAR_CUSTOM)
+            {
+                written = appendLineText(configText, value);
+            }
+            else
+            {
+                configText.append(value);
+            }
+
+            if (!written)
+            {
+                // the last value that could be written stays in the file, and this one stays unsaved
+                configText.resize(lineStart);
+                configText.append(line.text);
+                line.rejected = true;
+                continue;
+            }
+
+            configText.append("\n");
+            line.text.assign(configText, lineStart, configText.npos);
+            line.valid = true;
+            continue;
+        }
+
+        configText.append(line.text);
+    }
+
+    if (!writeFileAtomic(path, configText))
+    {
+        return SAVE_FAILED;
+    }
+
+    // what was written is now the saved value
+    for (std::size_t i = 0; i < archivedCVars.size(); i++)
+    {
+        CVar &cvar = symbols[archivedCVars[i]].cvar;
+
+        if ((cvar.flags & CVAR_ARCHIVE) && !archivedLines[i].rejected)
+        {
+            cvar.saved = true;
+            cvar.savedBits = archivedLines[i].bits;
+            cvar.savedVersion = archivedLines[i].version;
+        }
+    }
+
+    lastConfigPath = path;
+
+    return SAVE_WRITTEN;
+}
+
+inline std::string_view Virtuoso::QuakeStyleConsole::exactNumberText(CVarType type, double value, char (&buf)[40])
+{
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    // shortest text that reads back as the same value
+    std::to_chars_result result = (type == CVAR_FLOAT) ? std::to_chars(buf, buf + sizeof(buf), static_cast<float>(value))
+                                                       : std::to_chars(buf, buf + sizeof(buf), value);
+    return std::string_view(buf, result.ptr - buf);
+#else
+    const int length = std::snprintf(buf, sizeof(buf), (type == CVAR_FLOAT) ? "%.9g" : "%.17g", value);
+    return std::string_view(buf, (length > 0) ? std::size_t(length) : 0);
+#endif
+}
+
+inline bool Virtuoso::QuakeStyleConsole::appendToken(std::string &out, std::string_view value)
+{
+    if (value.find_first_of("\"\r\n") != value.npos)
+    {
+        return false;
+    }
+
+    const bool quote = value.empty() || value[0] == '#' || value[0] == '$' || std::any_of(value.begin(), value.end(), isConsoleSpace);
+
+    if (quote)
+    {
+        out.append("\"").append(value).append("\"");
+    }
+    else
+    {
+        out.append(value);
+    }
+
+    return true;
+}
+
+inline bool Virtuoso::QuakeStyleConsole::appendLineText(std::string &out, std::string_view value)
+{
+    if (value.empty())
+    {
+        return false;
+    }
+
+    for (std::size_t i = 0; i < value.size(); i++)
+    {
+        const char c = value[i];
+
+        if (c == '\r' || c == '\n')
+        {
+            return false;
+        }
+
+        // special only at the start of a token
+        if ((c == '#' || c == '$') && (i == 0 || isConsoleSpace(value[i - 1])))
+        {
+            return false;
+        }
+    }
+
+    out.append(value);
+    return true;
+}
+
+inline Virtuoso::QuakeStyleConsole::BatchResult Virtuoso::QuakeStyleConsole::loadConfig(const std::string &path, std::ostream &os)
+{
+    loadingConfig = true;
+    BatchResult result = executeFile(path, os, EXECUTE_SILENT);
+    loadingConfig = false;
+
+    std::error_code ec;
+
+    if (std::filesystem::exists(path, ec))
+    {
+        lastConfigPath = path;
+    }
+
+    return result;
+}
+
+inline bool Virtuoso::QuakeStyleConsole::writeFileAtomic(const std::string &path, std::string_view data)
+{
+    const std::string temp = path + ".tmp";
+
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        file.write(data.data(), std::streamsize(data.size()));
+        file.close();
+
+        if (!file)
+        {
+            std::remove(temp.c_str());
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(temp, path, ec);
+
+    if (ec)
+    {
+        std::remove(temp.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+inline bool Virtuoso::QuakeStyleConsole::saveSnapshot(const std::string &path)
+{
+    mergeStaticSymbols();
+
+    std::vector<SnapshotEntry> entries;
+    std::vector<SnapshotLine> lines;
+    std::string pool;
+
+    // copies text into the pool and returns where it went
+    auto store = [&pool](std::string_view text) {
+        const std::uint32_t offset = static_cast<std::uint32_t>(pool.size());
+        pool.append(text);
+        return offset;
+    };
+
+    for (SymbolID id = 0; id < symbols.size(); id++)
+    {
+        const Symbol &symbol = symbols[id];
+        const CVar &cvar = symbol.cvar;
+
+        if (!cvar || (cvar.flags & CVAR_READONLY))
+        {
+            continue;
+        }
+
+        SnapshotEntry entry{};
+        entry.symbol = id;
+        entry.nameHash = symbol.hash;
+        entry.nameOffset = store(symbol.name);
+        entry.nameLength = static_cast<std::uint32_t>(symbol.name.size());
+        entry.flags = cvar.flags;
+        entry.type = cvar.type;
+
+        if (cvar.type == CVAR_STRING || cvar.type == CVAR_CUSTOM)
+        {
+            const std::string_view value = (cvar.type == CVAR_STRING) ? std::string_view(*static_cast<const std::string *>(cvar.data)) : cvarText(cvar);
+            entry.valueOffset = store(value);
+            entry.valueLength = static_cast<std::uint32_t>(value.size());
+        }
+        else
+        {
+            entry.bits = cvarBits(cvar);
+        }
+
+        entries.push_back(entry);
+    }
+
+    for (const std::string &line : history_buffer)
+    {
+        lines.push_back({store(line), static_cast<std::uint32_t>(line.size())});
+    }
+
+    if (pool.size() > std::numeric_limits<std::uint32_t>::max())
+    {
+        return false;
+    }
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, "QSCSNAP", sizeof(header.magic));
+    header.version = snapshotVersion;
+    header.byteOrder = snapshotByteOrder;
+    header.entrySize = sizeof(SnapshotEntry);
+    header.entryCount = static_cast<std::uint32_t>(entries.size());
+    header.historyCount = static_cast<std::uint32_t>(lines.size());
+    header.poolSize = static_cast<std::uint32_t>(pool.size());
+
+    std::string data;
+    data.reserve(sizeof(header) + entries.size() * sizeof(SnapshotEntry) + lines.size() * sizeof(SnapshotLine) + pool.size());
+    data.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    data.append(reinterpret_cast<const char *>(entries.data()), entries.size() * sizeof(SnapshotEntry));
+    data.append(reinterpret_cast<const char *>(lines.data()), lines.size() * sizeof(SnapshotLine));
+    data.append(pool);
+
+    return writeFileAtomic(path, data);
+}
+
+inline Virtuoso::QuakeStyleConsole::SnapshotResult Virtuoso::QuakeStyleConsole::loadSnapshot(const std::string &path, std::ostream &os)
+{
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    SnapshotResult result;
+    MappedFile mapped;
+
+    if (!mapped.open(path))
+    {
+        return result; // no snapshot yet
+    }
+
+    const std::string_view file = mapped.view();
+
+    SnapshotHeader header{};
+    bool valid = file.size() >= sizeof(header);
+
+    if (valid)
+    {
+        std::memcpy(&header, file.data(), sizeof(header));
+        valid = std::memcmp(header.magic, "QSCSNAP", sizeof(header.magic)) == 0 && header.byteOrder == snapshotByteOrder;
+    }
+
+    if (valid && header.version != snapshotVersion)
+    {
+        return result; // written by another version of the console, so the caller should use its text config instead
+    }
+
+    const std::uint64_t poolStart = sizeof(header) + std::uint64_t(header.entryCount) * sizeof(SnapshotEntry) + std::uint64_t(header.historyCount) * sizeof(SnapshotLine);
+
+    if (!valid || header.entrySize != sizeof(SnapshotEntry) || poolStart + header.poolSize != file.size())
+    {
+        raiseError(os) << "Damaged snapshot : " << path << std::endl;
+        return result;
+    }
+
+    const char *entryData = file.data() + sizeof(header);
+    const char *lineData = entryData + std::size_t(header.entryCount) * sizeof(SnapshotEntry);
+    const std::string_view pool = file.substr(poolStart);
+
+    // bounds checks a range of the pool
+    auto poolText = [&pool](std::uint32_t offset, std::uint32_t length, std::string_view &text) {
+        if (std::uint64_t(offset) + length > pool.size())
+        {
+            return false;
+        }
+
+        text = pool.substr(offset, length);
+        return true;
+    };
+
+    snapshotText.clear();
+    std::size_t damaged = 0;
+
+    for (std::uint32_t i = 0; i < header.entryCount; i++)
+    {
+        SnapshotEntry entry;
+        std::memcpy(&entry, entryData + std::size_t(i) * sizeof(SnapshotEntry), sizeof(entry));
+
+        std::string_view name, value;
+
+        if (!poolText(entry.nameOffset, entry.nameLength, name) || !poolText(entry.valueOffset, entry.valueLength, value))
+        {
+            damaged++;
+            continue;
+        }
+
+        // the saved id is right as long as the same names were bound in the same order, which the hash and name confirm
+        CVar *cvar = nullptr;
+        bool direct = false;
+
+        if (entry.symbol < symbols.size())
+        {
+            Symbol &symbol = symbols[entry.symbol];
+
+            if (symbol.hash == entry.nameHash && symbol.cvar && symbol.name == name)
+            {
+                cvar = &symbol.cvar;
+                direct = true;
+            }
+        }
+
+        if (!cvar)
+        {
+            cvar = lookupCVar(name);
+        }
+
+        if (!cvar)
+        {
+            if (entry.flags & CVAR_DYNAMIC)
+            {
+                DynamicVariable var;
+                var.assign(value.data(), value.size());
+                bindDynamicCVar(std::string(name), var);
+                result.lookedUp++;
+            }
+            else
+            {
+                result.skipped++;
+            }
+
+            continue;
+        }
+
+        if (cvar->flags & CVAR_READONLY)
+        {
+            result.skipped++;
+            continue;
+        }
+
+        bool applied = (cvar->type == entry.type);
+
+        if (applied)
+        {
+            switch (entry.type)
+            {
+            case CVAR_INT:
+                std::memcpy(cvar->data, &entry.bits, sizeof(int));
+                break;
+            case CVAR_FLOAT:
+                std::memcpy(cvar->data, &entry.bits, sizeof(float));
+                break;
+            case CVAR_DOUBLE:
+                std::memcpy(cvar->data, &entry.bits, sizeof(double));
+                break;
+            case CVAR_BOOL:
+                *static_cast<bool *>(cvar->data) = entry.bits != 0;
+                break;
+            case CVAR_STRING:
+                static_cast<std::string *>(cvar->data)->assign(value.data(), value.size());
+                break;
+            case CVAR_CUSTOM:
+                // a var takes its whole value as one argument.  Other custom types have their own parsers, so they go through set
+                applied = (cvar->flags & entry.flags & CVAR_DYNAMIC) != 0;
+
+                if (applied)
+                {
+                    ConsoleArgs args(value, &value, 1);
+                    applied = cvar->read(args, os);
+                }
+                break;
+            default:
+                applied = false;
+                break;
+            }
+        }
+
+        if (applied)
+        {
+            cvarChanged(*cvar);
+            (direct ? result.direct : result.lookedUp)++;
+            continue;
+        }
+
+        const std::size_t lineStart = snapshotText.size();
+
+        snapshotText.append("set ").append(name).append(" ");
+
+        char numberBuf[40];
+
+        switch (entry.type)
+        {
+        case CVAR_INT:
+        {
+            int x;
+            std::memcpy(&x, &entry.bits, sizeof(x));
+            snapshotText.append(std::to_string(x));
+            break;
+        }
+        case CVAR_FLOAT:
+        {
+            float x;
+            std::memcpy(&x, &entry.bits, sizeof(x));
+            snapshotText.append(exactNumberText(CVAR_FLOAT, x, numberBuf));
+            break;
+        }
+        case CVAR_DOUBLE:
+        {
+            double x;
+            std::memcpy(&x, &entry.bits, sizeof(x));
+            snapshotText.append(exactNumberText(CVAR_DOUBLE, x, numberBuf));
+            break;
+        }
+        case CVAR_BOOL:
+            snapshotText.append(entry.bits ? "1" : "0");
+            break;
+        case CVAR_STRING:
+            if (!appendToken(snapshotText, value))
+            {
+                // a set line can't hold it, and replaying it cut short would set the wrong value
+                snapshotText.resize(lineStart);
+                result.skipped++;
+                continue;
+            }
+            break;
+        default:
+            if (!appendLineText(snapshotText, value))
+            {
+                snapshotText.resize(lineStart);
+                result.skipped++;
+                continue;
+            }
+            break;
+        }
+
+        snapshotText.append("\n");
+        result.replayed++;
+    }
+
+    if (snapshotText.size())
+    {
+        executeBatch(snapshotText, os, EXECUTE_SILENT);
+    }
+
+    history_buffer.clear();
+
+    for (std::uint32_t i = 0; i < header.historyCount; i++)
+    {
+        SnapshotLine line;
+        std::memcpy(&line, lineData + std::size_t(i) * sizeof(SnapshotLine), sizeof(line));
+
+        std::string_view text;
+
+        if (!poolText(line.offset, line.length, text))
+        {
+            damaged++;
+            continue;
+        }
+
+        history_buffer.emplace(text);
+        result.history++;
+    }
+
+    if (damaged)
+    {
+        raiseError(os) << damaged << " damaged entries in snapshot " << path << std::endl;
+    }
+
+    result.loaded = true;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    return result;
+}
+
+inline std::string_view Virtuoso::QuakeStyleConsole::cvarText(const CVar &cvar)
+{
+    if (cvar.type == CVAR_STRING)
+    {
+        // a string prints as itself, so there's nothing to cache
+        std::string_view value = *static_cast<const std::string *>(cvar.data);
+
+        while (value.size() && isConsoleSpace(value.back()))
+        {
+            value.remove_suffix(1);
+        }
+
+        return value;
+    }
+
+    const std::uint64_t bits = cvarBits(cvar);
+
+    const bool cacheable = (cvar.type != CVAR_CUSTOM) || (cvar.flags & CVAR_CACHE_TEXT);
+
+    if (!cacheable || !cvar.textCached || cvar.textVersion != cvar.version || cvar.textBits != bits)
+    {
+        cvar.text.clear();
+
+        {
+            StringAppendBuf buf(cvar.text);
+            std::ostream valueStream(&buf);
+
+            writeCVar(cvar, valueStream);
+        }
+
+        // printers end with a newline; it shouldn't end up in the argument text
+        while (cvar.text.size() && isConsoleSpace(cvar.text.back()))
+        {
+            cvar.text.pop_back();
+        }
+
+        cvar.textBits = bits;
+        cvar.textVersion = cvar.version;
+        cvar.textCached = cacheable;
+    }
+
+    return cvar.text;
+}
+
+template <class T>
+inline const T *Virtuoso::QuakeStyleConsole::findCVar(std::string_view name)
+{
+    static_assert(CVarTypeOf<T>::value != CVAR_CUSTOM, "Typed cvar access works on int, float, double, bool and std::string");
+
+    const CVar *cvar = lookupCVar(name);
+
+    return (cvar && cvar->type == CVarTypeOf<T>::value) ? static_cast<const T *>(cvar->data) : nullptr;
+}
+
+template <class T>
+inline std::optional<T> Virtuoso::QuakeStyleConsole::getCVar(std::string_view name)
+{
+    if (const T *value = findCVar<T>(name))
+    {
+        return *value;
+    }
+
+    return std::nullopt;
+}
+
+template <class T>
+inline bool Virtuoso::QuakeStyleConsole::setCVar(std::string_view name, const T &value)
+{
+    static_assert(CVarTypeOf<T>::value != CVAR_CUSTOM, "Typed cvar access works on int, float, double, bool and std::string");
+
+    CVar *cvar = lookupCVar(name);
+
+    if (!cvar || cvar->type != CVarTypeOf<T>::value)
+    {
+        return false;
+    }
+
+    *static_cast<T *>(cvar->data) = value;
+    cvarChanged(*cvar);
+
+    return true;
+}
+
+template <class T>
+inline void Virtuoso::QuakeStyleConsole::printCvar(std::ostream &os, T *var)
+{
+    os << *var << std::endl;
+}
+
+/// static commands with no arguments
+template <>
+struct Virtuoso::QuakeStyleConsole::StaticInvoker<void (*)()>
+{
+    template <void (*F)()>
+    static void call(QuakeStyleConsole &, ConsoleArgs &, std::ostream &) { F(); }
+};
+
+/// static commands whose arguments are parsed like bindCommand's
+template <typename... Args>
+struct Virtuoso::QuakeStyleConsole::StaticInvoker<void (*)(Args...)>
+{
+    template <void (*F)(Args...)>
+    static void call(QuakeStyleConsole &console, ConsoleArgs &args, std::ostream &os) { console.parse<Args...>(args, os, F); }
+};
+
+/// static commands that read the argument cursor themselves
+template <>
+struct Virtuoso::QuakeStyleConsole::StaticInvoker<void (*)(Virtuoso::ConsoleArgs &, std::ostream &)>
+{
+    template <void (*F)(ConsoleArgs &, std::ostream &)>
+    static void call(QuakeStyleConsole &, ConsoleArgs &args, std::ostream &os) { F(args, os); }
+};
+
+/// static commands that also need the console, eg. to run other commands
+template <>
+struct Virtuoso::QuakeStyleConsole::StaticInvoker<void (*)(Virtuoso::QuakeStyleConsole &, Virtuoso::ConsoleArgs &, std::ostream &)>
+{
+    template <void (*F)(QuakeStyleConsole &, ConsoleArgs &, std::ostream &)>
+    static void call(QuakeStyleConsole &console, ConsoleArgs &args, std::ostream &os) { F(console, args, os); }
+};
+
+template <auto F>
+constexpr Virtuoso::StaticSymbol Virtuoso::QuakeStyleConsole::staticCommand(std::string_view name, std::string_view help)
+{
+    StaticSymbol symbol;
+    symbol.name = name;
+    symbol.command = &StaticInvoker<decltype(F)>::template call<F>;
+    symbol.help = help;
+    return symbol;
+}
+
+template <auto *V>
+constexpr Virtuoso::StaticSymbol Virtuoso::QuakeStyleConsole::staticCVar(std::string_view name, std::string_view help)
+{
+    typedef typename std::remove_pointer<decltype(V)>::type T;
+
+    StaticSymbol symbol;
+    symbol.name = name;
+    symbol.type = CVarTypeOf<T>::value;
+
+    if constexpr (CVarTypeOf<T>::value == CVAR_CUSTOM)
+    {
+        symbol.read = &staticRead<V>;
+        symbol.print = &staticPrint<V>;
+    }
+    else
+    {
+        symbol.data = V;
+    }
+
+    symbol.help = help;
+    return symbol;
+}
+
+inline const Virtuoso::StaticSymbol *Virtuoso::StaticSymbolTable::find(std::string_view name) const
+{
+    const StaticSymbol *end = symbols + count;
+
+    const StaticSymbol *it = std::lower_bound(symbols, end, name, [](const StaticSymbol &s, std::string_view n) { return s.name < n; });
+
+    return (it != end && it->name == name) ? it : nullptr;
+}
+
+inline const Virtuoso::StaticSymbol *Virtuoso::StaticSymbolRegistry::find(std::string_view name)
+{
+    for (const StaticSymbolTable *table = head; table; table = table->next)
+    {
+        if (const StaticSymbol *s = table->find(name))
+        {
+            return s;
+        }
+    }
+
+    return nullptr;
+}
+
+inline void Virtuoso::QuakeStyleConsole::mergeStaticSymbols()
+{
+    // tables register at the front of the list, so everything before the last merged head is new
+    for (const StaticSymbolTable *table = StaticSymbolRegistry::head; table != mergedStaticHead; table = table->next)
+    {
+        for (std::size_t i = 0; i < table->count; i++)
+        {
+            const StaticSymbol &s = table->symbols[i];
+            const SymbolID id = symbols.intern(s.name);
+            Symbol &symbol = symbols[id];
+
+            if (s.command && !symbol.command)
+            {
+                symbol.command = [this, f = s.command](ConsoleArgs &args, std::ostream &os) { f(*this, args, os); };
+                symbolsVersion++;
+                namesVersion++;
+            }
+
+            if (s.type != CVAR_NONE && !symbol.cvar)
+            {
+                symbol.cvar.type = s.type;
+                symbol.cvar.data = s.data;
+                symbol.cvar.symbol = id;
+                refreshWatchModes(symbol.cvar);
+                namesVersion++;
+
+                if (s.type == CVAR_CUSTOM)
+                {
+                    symbol.cvar.read = [this, f = s.read](ConsoleArgs &args, std::ostream &os) { return f(*this, args, os); };
+                    symbol.cvar.print = [this, f = s.print](std::ostream &os) { f(*this, os); };
+                }
+            }
+
+            if (s.help.length() && symbol.help.empty())
+            {
+                symbol.help = HelpText::borrow(s.help); // static tables live for the whole program
+                namesVersion++;
+            }
+        }
+    }
+
+    mergedStaticHead = StaticSymbolRegistry::head;
+}
+
+inline std::size_t Virtuoso::QuakeStyleConsole::completeName(std::string_view prefix, std::vector<SymbolID> &matches, unsigned kinds)
+{
+    mergeStaticSymbols();
+
+    const std::size_t first = matches.size();
+    const std::pair<const SymbolID *, const SymbolID *> range = symbols.prefixRange(prefix);
+
+    for (const SymbolID *it = range.first; it != range.second; ++it)
+    {
+        const Symbol &symbol = symbols[*it];
+
+        if (((kinds & SYMBOL_COMMAND) && symbol.command) || ((kinds & SYMBOL_CVAR) && symbol.cvar) || ((kinds & SYMBOL_HELP) && !symbol.help.empty()))
+        {
+            matches.push_back(*it);
+        }
+    }
+
+    if (matches.size() == first)
+    {
+        return 0;
+    }
+
+    // the names are sorted, so what the first and last share, every name between them shares too
+    return SymbolTable::commonPrefix(symbols[matches[first]].name, symbols[matches.back()].name);
+}
+
+inline std::uint32_t Virtuoso::QuakeStyleConsole::letterMask(std::string_view text)
+{
+    std::uint32_t mask = 0;
+
+    for (char c : text)
+    {
+        const int lower = std::tolower(static_cast<unsigned char>(c));
+
+        if (lower >= 'a' && lower <= 'z')
+        {
+            mask |= 1u << (lower - 'a');
+        }
+        else if (lower >= '0' && lower <= '9')
+        {
+            mask |= 1u << 26;
+        }
+        else
+        {
+            mask |= (lower == '_') ? (1u << 27) : (1u << 28);
+        }
+    }
+
+    return mask;
+}
+
+inline bool Virtuoso::QuakeStyleConsole::fuzzyScore(std::string_view lowerName, std::string_view name, std::string_view lowerQuery, int &score)
+{
+    score = 0;
+
+    std::size_t q = 0;
+    std::size_t first = lowerName.npos;
+    std::size_t previous = lowerName.npos;
+
+    for (std::size_t i = 0; i < lowerName.size() && q < lowerQuery.size(); i++)
+    {
+        if (lowerName[i] != lowerQuery[q])
+        {
+            continue;
+        }
+
+        int points = 16;
+
+        if (i == 0)
+        {
+            points += 32;
+        }
+        else
+        {
+            const unsigned char before = static_cast<unsigned char>(name[i - 1]);
+            const unsigned char here = static_cast<unsigned char>(name[i]);
+
+            if (before == '_' || before == '.' || before == '-' || before == ' ')
+            {
+                points += 24; // start of a word
+            }
+            else if (std::isupper(here) && std::islower(before))
+            {
+                points += 24; // camelCase hump
+            }
+            else if (std::isdigit(here) && !std::isdigit(before))
+            {
+                points += 8;
+            }
+        }
+
+        if (previous != lowerName.npos && previous + 1 == i)
+        {
+            points += 20; // runs of adjacent letters
+        }
+
+        if (first == lowerName.npos)
+        {
+            first = i;
+        }
+
+        score += points;
+        previous = i;
+        q++;
+    }
+
+    if (q < lowerQuery.size())
+    {
+        return false;
+    }
+
+    // the earlier the match starts and the shorter the name, the likelier it's the one being typed
+    score -= 2 * static_cast<int>(std::min<std::size_t>(first, 16));
+    score -= static_cast<int>(std::min<std::size_t>(lowerName.size(), 64)) / 4;
+
+    return true;
+}
+
+inline std::size_t Virtuoso::QuakeStyleConsole::fuzzyComplete(std::string_view query, std::vector<FuzzyMatch> &results, std::size_t maxResults, unsigned kinds)
+{
+    mergeStaticSymbols();
+
+    // bring the packed names up to date with the symbol table
+    for (std::size_t id = fuzzyIndex.offsets.size(); id < symbols.size(); id++)
+    {
+        const std::string_view name = symbols[SymbolID(id)].name;
+
+        fuzzyIndex.offsets.push_back(static_cast<std::uint32_t>(fuzzyIndex.names.size()));
+        fuzzyIndex.lengths.push_back(static_cast<std::uint32_t>(name.size()));
+        fuzzyIndex.masks.push_back(letterMask(name));
+
+        for (char c : name)
+        {
+            fuzzyIndex.names.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+        }
+
+        fuzzyIndex.names.push_back('\0');
+        fuzzyIndex.names.append(name);
+        fuzzyIndex.names.push_back('\0');
+    }
+
+    if (query.empty() || maxResults == 0)
+    {
+        return 0;
+    }
+
+    char lowerBuf[64];
+    std::string lowerLong;
+    std::string_view lowerQuery;
+
+    if (query.size() <= sizeof(lowerBuf))
+    {
+        std::transform(query.begin(), query.end(), lowerBuf, [](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+        lowerQuery = std::string_view(lowerBuf, query.size());
+    }
+    else
+    {
+        lowerLong.assign(query);
+        std::transform(lowerLong.begin(), lowerLong.end(), lowerLong.begin(), [](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+        lowerQuery = lowerLong;
+    }
+
+    const std::uint32_t queryMask = letterMask(lowerQuery);
+
+    // a name missing the letters of a query is missing them for any query that extends it.  The names added to the index since
+    // the last query bumped namesVersion when they were bound, so matching versions means the survivors still cover every name
+    FuzzyNarrowing &last = fuzzyNarrowing;
+    const bool narrow = last.query.size() && last.namesVersion == namesVersion && lowerQuery.size() >= last.query.size() &&
+                        lowerQuery.compare(0, last.query.size(), last.query) == 0;
+
+    if (narrow && lowerQuery.size() == last.query.size() && last.maxResults == maxResults && last.kinds == kinds)
+    {
+        // nothing changed since the last frame asked
+        results.insert(results.end(), fuzzyHeap.begin(), fuzzyHeap.end());
+        return fuzzyHeap.size();
+    }
+
+    // the most fuzzyScore() can give before the length penalty : the first letter at the start, every other one starting a word right after the last
+    const int bestScore = 48 + 60 * static_cast<int>(std::min<std::size_t>(lowerQuery.size() - 1, 1u << 20));
+
+    fuzzyHeap.clear();
+
+    const std::uint32_t *masks = fuzzyIndex.masks.data();
+    const std::uint32_t *offsets = fuzzyIndex.offsets.data();
+    const std::uint32_t *lengths = fuzzyIndex.lengths.data();
+    const char *names = fuzzyIndex.names.data();
+    const std::size_t count = fuzzyIndex.masks.size();
+
+    // most names are missing one of the query's letters.  This pass throws them out with one compare each, and has no branches,
+    // so the compiler can vectorize it
+    fuzzyCandidates.resize(narrow ? last.survivors.size() : count);
+    SymbolID *candidates = fuzzyCandidates.data();
+    std::size_t candidateCount = 0;
+
+    if (narrow)
+    {
+        for (SymbolID id : last.survivors)
+        {
+            candidates[candidateCount] = id;
+            candidateCount += (masks[id] & queryMask) == queryMask;
+        }
+    }
+    else
+    {
+        for (std::size_t id = 0; id < count; id++)
+        {
+            candidates[candidateCount] = SymbolID(id);
+            candidateCount += (masks[id] & queryMask) == queryMask;
+        }
+    }
+
+    // the candidates that fuzzyScore() doesn't turn down are packed to the front as they go, to be the next query's survivors.
+    // Names skipped for length were never checked, so they stay
+    std::size_t survivorCount = 0;
+
+    // the heap keeps the worst of the best maxResults on top.  Between equal scores the name that sorts first ranks higher, the
+    // same order the results come back in, so which ties make the cut doesn't depend on the order names were bound in
+    // The packed lower cased names compare with memcmp in the same order as SymbolTable::nameLess()
+    auto nameLess = [names, offsets, lengths](SymbolID a, SymbolID b) {
+        const std::string_view lowerA(names + offsets[a], lengths[a]);
+        const std::string_view lowerB(names + offsets[b], lengths[b]);
+        const int order = lowerA.compare(lowerB);
+
+        return order ? order < 0 : std::string_view(lowerA.data() + lengths[a] + 1, lengths[a]) < std::string_view(lowerB.data() + lengths[b] + 1, lengths[b]);
+    };
+    auto ranksAbove = [&nameLess](const FuzzyMatch &a, const FuzzyMatch &b) { return a.score != b.score ? a.score > b.score : nameLess(a.id, b.id); };
+
+    for (std::size_t c = 0; c < candidateCount; c++)
+    {
+        const SymbolID id = candidates[c];
+        const bool full = fuzzyHeap.size() >= maxResults;
+
+        // once the list is full, names too long to beat the worst of it even with a perfect match aren't scored at all.
+        // For short queries, where the letter filter lets most names through, that's most of them.  A name that doesn't start
+        // with the query's first letter can at best start a word with it, after at least one letter : 10 points less.
+        // A name that could at best tie is only scored if it would win the tie on its name
+        const int bound = full ? bestScore - static_cast<int>(std::min<std::uint32_t>(lengths[id], 64)) / 4 - (names[offsets[id]] != lowerQuery[0] ? 10 : 0) : 0;
+
+        if (full && (bound < fuzzyHeap.front().score || (bound == fuzzyHeap.front().score && !ranksAbove(FuzzyMatch{id, bound}, fuzzyHeap.front()))))
+        {
+            candidates[survivorCount++] = id;
+            continue;
+        }
+
+        const std::string_view lowerName(names + offsets[id], lengths[id]);
+        const std::string_view name(lowerName.data() + lengths[id] + 1, lengths[id]);
+        int score;
+
+        if (!fuzzyScore(lowerName, name, lowerQuery, score))
+        {
+            continue;
+        }
+
+        candidates[survivorCount++] = id;
+
+        if (full && !ranksAbove(FuzzyMatch{id, score}, fuzzyHeap.front()))
+        {
+            continue;
+        }
+
+        // only names good enough to make the list are checked against kinds, since that means reaching into the symbol record
+        const Symbol &symbol = symbols[id];
+
+        if (!(((kinds & SYMBOL_COMMAND) && symbol.command) || ((kinds & SYMBOL_CVAR) && symbol.cvar) || ((kinds & SYMBOL_HELP) && !symbol.help.empty())))
+        {
+            continue;
+        }
+
+        if (full)
+        {
+            std::pop_heap(fuzzyHeap.begin(), fuzzyHeap.end(), ranksAbove);
+            fuzzyHeap.back() = FuzzyMatch{id, score};
+        }
+        else
+        {
+            fuzzyHeap.push_back(FuzzyMatch{id, score});
+        }
+
+        std::push_heap(fuzzyHeap.begin(), fuzzyHeap.end(), ranksAbove);
+    }
+
+    // best first, and alphabetical between equal scores
+    std::sort(fuzzyHeap.begin(), fuzzyHeap.end(), ranksAbove);
+
+    fuzzyCandidates.resize(survivorCount);
+    last.survivors.swap(fuzzyCandidates);
+    last.query.assign(lowerQuery);
+    last.namesVersion = namesVersion;
+    last.maxResults = maxResults;
+    last.kinds = kinds;
+
+    results.insert(results.end(), fuzzyHeap.begin(), fuzzyHeap.end());
+
+    return fuzzyHeap.size();
+}
+
+inline void Virtuoso::QuakeStyleConsole::setCompletion(const std::string &command, CompletionProvider provider)
+{
+    completers[symbols.intern(command)] = std::move(provider);
+}
+
+inline void Virtuoso::QuakeStyleConsole::completeNames(std::string_view word, unsigned kinds, CompletionResult &result)
+{
+    completeIds.clear();
+    completeName(word, completeIds, kinds);
+
+    for (SymbolID id : completeIds)
+    {
+        result.candidates.emplace_back(symbols[id].name);
+    }
+}
+
+inline void Virtuoso::QuakeStyleConsole::complete(std::string_view line, std::size_t cursor, CompletionResult &result)
+{
+    result.candidates.clear();
+    result.argument = 0;
+    result.command = invalidSymbol;
+    result.commonLength = 0;
+    result.fuzzy = false;
+    result.pending = false;
+
+    auto isBreak = [](char c) { return c == ' ' || c == '\t' || c == ',' || c == ';'; };
+
+    cursor = std::min(cursor, line.size());
+
+    std::size_t begin = cursor;
+
+    while (begin > 0 && !isBreak(line[begin - 1]))
+    {
+        begin--;
+    }
+
+    result.wordBegin = begin;
+    result.wordEnd = cursor;
+
+    const std::string_view word = line.substr(begin, cursor - begin);
+
+    // the command is the first word after the last ; so alias bodies work too
+    std::size_t segment = line.rfind(';', begin ? begin - 1 : 0);
+    segment = (segment == line.npos || segment >= begin) ? 0 : segment + 1;
+
+    std::string_view commandName;
+    std::size_t argument = 0;
+
+    for (std::size_t i = segment; i < begin;)
+    {
+        while (i < begin && isConsoleSpace(line[i]))
+        {
+            i++;
+        }
+
+        const std::size_t tokenBegin = i;
+
+        while (i < begin && !isConsoleSpace(line[i]))
+        {
+            i++;
+        }
+
+        if (i > tokenBegin)
+        {
+            if (argument == 0)
+            {
+                commandName = line.substr(tokenBegin, i - tokenBegin);
+            }
+
+            argument++;
+        }
+    }
+
+    result.argument = argument;
+
+    if (argument)
+    {
+        result.command = symbols.find(commandName);
+
+        auto it = (result.command == invalidSymbol) ? completers.end() : completers.find(result.command);
+
+        if (it != completers.end())
+        {
+            it->second(word, argument, result);
+        }
+        else
+        {
+            completeNames(word, SYMBOL_COMMAND | SYMBOL_CVAR, result);
+        }
+    }
+    else
+    {
+        completeNames(word, SYMBOL_COMMAND | SYMBOL_CVAR, result);
+
+        if (result.candidates.empty() && word.size())
+        {
+            completeFuzzy.clear();
+            fuzzyComplete(word, completeFuzzy, 16, SYMBOL_COMMAND | SYMBOL_CVAR);
+
+            for (const FuzzyMatch &match : completeFuzzy)
+            {
+                result.candidates.emplace_back(symbols[match.id].name);
+            }
+
+            result.fuzzy = result.candidates.size() > 0;
+        }
+    }
+
+    if (result.candidates.size())
+    {
+        const std::string &first = result.candidates.front();
+        std::size_t common = first.size();
+
+        for (const std::string &candidate : result.candidates)
+        {
+            common = std::min(common, SymbolTable::commonPrefix(first, candidate));
+        }
+
+        result.commonLength = common;
+    }
+}
+
+inline Virtuoso::QuakeStyleConsole::CompletionProvider Virtuoso::QuakeStyleConsole::cvarNameCompletion()
+{
+    return [this](std::string_view word, std::size_t argument, CompletionResult &result) {
+        if (argument == 1)
+        {
+            completeNames(word, SYMBOL_CVAR, result);
+        }
+    };
+}
+
+inline Virtuoso::QuakeStyleConsole::CompletionProvider Virtuoso::QuakeStyleConsole::helpTopicCompletion()
+{
+    return [this](std::string_view word, std::size_t argument, CompletionResult &result) {
+        if (argument == 1)
+        {
+            completeNames(word, SYMBOL_HELP, result);
+        }
+    };
+}
+
+inline Virtuoso::QuakeStyleConsole::CompletionProvider Virtuoso::QuakeStyleConsole::filePathCompletion(std::string root, double refreshSeconds)
+{
+    /// a directory's entries, sorted, with / after subdirectories
+    struct Listing
+    {
+        std::vector<std::string> entries;
+        std::chrono::steady_clock::time_point listed;
+        bool valid = false;   ///< entries have been listed at least once
+        bool listing = false; ///< a job is listing it now
+    };
+
+    /// shared with the listing jobs, which can outlive the provider
+    struct Cache
+    {
+        std::mutex mutex;
+        std::unordered_map<std::string, Listing> directories;
+    };
+
+    std::shared_ptr<Cache> cache = std::make_shared<Cache>();
+    const std::chrono::steady_clock::duration refresh = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(refreshSeconds));
+
+    return [this, cache, root, refresh](std::string_view word, std::size_t argument, CompletionResult &result) {
+        if (argument != 1)
+        {
+            return;
+        }
+
+        const std::size_t slash = word.find_last_of("/\\");
+        const std::string directory(word.substr(0, slash == word.npos ? 0 : slash + 1));
+        const std::string_view leaf = word.substr(directory.size());
+
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+        std::lock_guard<std::mutex> lock(cache->mutex);
+        Listing &listing = cache->directories[directory];
+
+        if (!listing.listing && (!listing.valid || now - listing.listed > refresh))
+        {
+            listing.listing = true;
+
+            const std::filesystem::path path = std::filesystem::path(root) / directory;
+
+            startJob("list " + (directory.empty() ? std::string(".") : directory), [cache, directory, path](ConsoleJob &job) {
+                std::vector<std::string> entries;
+                std::error_code ec;
+
+                for (std::filesystem::directory_iterator it(path, ec), end; !ec && it != end && !job.cancelled(); it.increment(ec))
+                {
+                    std::error_code typeError;
+                    entries.push_back(it->path().filename().string() + (it->is_directory(typeError) ? "/" : ""));
+                }
+
+                std::sort(entries.begin(), entries.end(), SymbolTable::nameLess);
+
+                std::lock_guard<std::mutex> jobLock(cache->mutex);
+                Listing &done = cache->directories[directory];
+                done.entries.swap(entries);
+                done.listed = std::chrono::steady_clock::now();
+                done.valid = true;
+                done.listing = false;
+            },
+                     false);
+        }
+
+        result.pending |= listing.listing;
+
+        for (const std::string &entry : listing.entries)
+        {
+            if (SymbolTable::commonPrefix(entry, leaf) == leaf.size())
+            {
+                result.candidates.push_back(directory + entry);
+            }
+        }
+    };
+}
+
+template <class T>
+inline bool Virtuoso::QuakeStyleConsole::assignDynamicVariable(ConsoleArgs &args, std::shared_ptr<T> var)
+{
+    return ConsoleArgParser<T>::parse(args, *var);
+}
+
+template <class T>
+inline void Virtuoso::QuakeStyleConsole::writeDynamicVariable(std::ostream &os, std::shared_ptr<T> var)
+{
+    const T &deref = *(var);
+    os << deref;
+}
+
+template <class T>
+inline void Virtuoso::QuakeStyleConsole::bindDynamicCVar(const std::string &var, const T &value, HelpText help)
+{
+    setHelpTopic(var, std::move(help));
+    bindDynamicCVar(var, value);
+}
+
+template <class T>
+inline void Virtuoso::QuakeStyleConsole::bindDynamicCVar(const std::string &var, const T &valueIn)
+{
+    std::shared_ptr<T> ptr(new T(valueIn));
+
+    const SymbolID id = symbols.intern(var);
+    CVar &cvar = symbols[id].cvar;
+
+    cvar.type = CVAR_CUSTOM;
+    cvar.flags = CVAR_CACHE_TEXT | CVAR_DYNAMIC; // only the console can change it
+    cvar.data = nullptr;
+    cvar.symbol = id;
+    refreshWatchModes(cvar);
+    namesVersion++;
+
+    cvar.read =
+        [this, ptr](ConsoleArgs &args, std::ostream &) {
+            return this->assignDynamicVariable<T>(args, ptr);
+        };
+
+    cvar.print =
+        [this, ptr](std::ostream &os) {
+            this->writeDynamicVariable<T>(os, ptr);
+        };
+
+    cvarChanged(cvar); // declaring a variable from the console sets it
+}
+
+inline void Virtuoso::QuakeStyleConsole::executeUntilEOF(std::istream &f, std::ostream &output)
+{
+    while (!f.eof())
+    {
+        commandExecute(f, output);
+    }
+}
+
+inline Virtuoso::QuakeStyleConsole::BatchResult Virtuoso::QuakeStyleConsole::executeFile(const std::string &x, std::ostream &output, unsigned flags)
+{
+    {
+        MappedFile mapped;
+
+        if (mapped.open(x))
+        {
+            return executeBatch(mapped.view(), output, flags);
+        }
+    }
+
+    // not a regular file, eg. a pipe, or mapping isn't available
+    std::ifstream f(x, std::ios::binary);
+
+    if (!f.is_open())
+    {
+        raiseError(output) << "Unable to open file : " << x << std::endl;
+
+        BatchResult result;
+        result.errors = 1;
+        return result;
+    }
+
+    return executeBatch(f, output, flags);
+}
+
+inline Virtuoso::QuakeStyleConsole::EndOfLineEscapeStreamScope Virtuoso::QuakeStyleConsole::raiseError(std::ostream &os)
+{
+    errorCount++;
+    return os << error();
+}
+
+inline bool Virtuoso::QuakeStyleConsole::isExecutableLine(std::string_view line)
+{
+    std::size_t first = 0;
+
+    while (first < line.size() && isConsoleSpace(line[first]))
+    {
+        first++;
+    }
+
+    return first < line.size() && line[first] != '#';
+}
+
+template <class ForEachLine>
+inline Virtuoso::QuakeStyleConsole::BatchResult Virtuoso::QuakeStyleConsole::runBatch(const ForEachLine &forEachLine, std::ostream &os, unsigned flags, bool rewindable)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    BatchResult result;
+
+    // pushing lines that fall out of the history window before the batch ends is wasted work, so skip them
+    std::size_t historySkip = 0;
+
+    if ((flags & EXECUTE_HISTORY) && rewindable)
+    {
+        std::size_t executable = 0;
+
+        forEachLine([&executable](std::string_view line) {
+            executable += isExecutableLine(line);
+            return true;
+        });
+
+        historySkip = (executable > history_buffer.capacity()) ? executable - history_buffer.capacity() : 0;
+    }
+
+    {
+        ScratchScope scope(*this);
+
+        std::size_t lineNumber = 0;
+
+        forEachLine([&](std::string_view line) {
+            const unsigned lineFlags = (result.lines < historySkip) ? (flags & ~EXECUTE_HISTORY) : flags;
+            const std::uint64_t errorsBefore = errorCount;
+
+            if (executeLine(scope.scratch, line, os, lineFlags))
+            {
+                result.lines++;
+            }
+
+            return recordBatchErrors(result, errorsBefore, lineNumber++, flags);
+        });
+    }
+
+    finishBatch(result, start, os, flags);
+
+    return result;
+}
+
+inline bool Virtuoso::QuakeStyleConsole::recordBatchErrors(BatchResult &result, std::uint64_t errorsBefore, std::size_t lineNumber, unsigned flags)
+{
+    if (errorCount == errorsBefore)
+    {
+        return true;
+    }
+
+    result.errors += std::size_t(errorCount - errorsBefore);
+
+    if (result.failedLines++ == 0)
+    {
+        result.firstErrorLine = lineNumber;
+    }
+
+    if (flags & EXECUTE_STOP_ON_ERROR)
+    {
+        result.stopped = true;
+        return false;
+    }
+
+    return true;
+}
+
+inline void Virtuoso::QuakeStyleConsole::finishBatch(BatchResult &result, std::chrono::steady_clock::time_point start, std::ostream &os, unsigned flags)
+{
+    result.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (flags & EXECUTE_SUMMARY)
+    {
+        os << echo() << "batch: " << result.lines << " lines, " << result.errors << " errors";
+
+        if (result.failedLines)
+        {
+            os << " (first on line " << result.firstErrorLine + 1 << ")";
+        }
+
+        if (result.stopped)
+        {
+            os << ", stopped";
+        }
+
+        os << ", " << result.seconds * 1000.0 << " ms" << std::endl;
+    }
+}
+
+template <class T>
+inline Virtuoso::BoundedMPSCQueue<T>::BoundedMPSCQueue(std::size_t capacity)
+{
+    std::size_t size = 2;
+
+    while (size < capacity)
+    {
+        size *= 2;
+    }
+
+    cells.reset(new Cell[size]);
+    mask = size - 1;
+
+    for (std::size_t i = 0; i < size; i++)
+    {
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+template <class T>
+inline bool Virtuoso::BoundedMPSCQueue<T>::push(T &&value)
+{
+    std::size_t pos = enqueuePos.load(std::memory_order_relaxed);
+    Cell *cell;
+
+    for (;;)
+    {
+        cell = &cells[pos & mask];
+
+        const std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+        const std::intptr_t diff = std::intptr_t(seq) - std::intptr_t(pos);
+
+        if (diff == 0) // free; try to claim it
+        {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0) // still holds a value from a lap ago
+        {
+            return false;
+        }
+        else // another producer claimed it first
+        {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    cell->value = std::move(value);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+
+    return true;
+}
+
+template <class T>
+inline bool Virtuoso::BoundedMPSCQueue<T>::pop(T &value)
+{
+    Cell &cell = cells[dequeuePos & mask];
+
+    const std::size_t seq = cell.sequence.load(std::memory_order_acquire);
+
+    if (std::intptr_t(seq) - std::intptr_t(dequeuePos + 1) < 0) // not written yet
+    {
+        return false;
+    }
+
+    value = std::move(cell.value);
+    cell.sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+    dequeuePos++;
+
+    return true;
+}
+
+inline bool Virtuoso::QuakeStyleConsole::submit(std::string line, CompletionFunc done)
+{
+    QueuedLine queued{std::move(line), std::move(done)};
+
+    return queue.push(std::move(queued));
+}
+
+inline std::size_t Virtuoso::QuakeStyleConsole::drain(std::ostream &os, std::size_t maxLines, std::chrono::microseconds timeBudget, unsigned flags)
+{
+    const auto start = std::chrono::steady_clock::now();
+    const bool timed = timeBudget != std::chrono::microseconds::max();
+
+    std::size_t count = 0;
+    QueuedLine drained;
+
+    while (count < maxLines && queue.pop(drained))
+    {
+        count++;
+
+        if (drained.done)
+        {
+            drainOutput.clear();
+
+            {
+                StringAppendBuf buf(drainOutput);
+                std::ostream captured(&buf);
+
+                const BatchResult result = executeBatch(drained.line, captured, flags);
+
+                os << drainOutput;
+                drained.done(drainOutput, result);
+            }
+
+            drained.done = nullptr;
+        }
+        else
+        {
+            commandExecute(drained.line, os, flags);
+        }
+
+        if (timed && std::chrono::steady_clock::now() - start >= timeBudget)
+        {
+            break;
+        }
+    }
+
+    return count;
+}
+
+inline Virtuoso::QuakeStyleConsole::CommandFunc &Virtuoso::QuakeStyleConsole::commandSlot(std::string_view name)
+{
+    const SymbolID id = symbols.intern(name);
+
+    if (id == setSymbol)
+    {
+        setRebound = true;
+    }
+
+    symbolsVersion++;
+    namesVersion++;
+
+    return symbols[id].command;
+}
+
+inline Virtuoso::QuakeStyleConsole::BatchResult Virtuoso::QuakeStyleConsole::executeScript(const std::string &path, std::ostream &output, unsigned flags)
+{
+    std::shared_ptr<CompiledScript> script = cachedScript(path); // keeps it alive if it gets recompiled while running
+
+    if (!script)
+    {
+        return executeFile(path, output, flags);
+    }
+
+    return runCompiledScript(script, output, flags);
+}
+
+inline std::shared_ptr<Virtuoso::QuakeStyleConsole::CompiledScript> Virtuoso::QuakeStyleConsole::cachedScript(const std::string &path)
+{
+    std::error_code ec;
+    const std::filesystem::file_time_type modified = std::filesystem::last_write_time(path, ec);
+    const std::uintmax_t size = ec ? 0 : std::filesystem::file_size(path, ec);
+
+    if (ec)
+    {
+        // not a regular file (or it doesn't exist), so there's nothing to key a cache entry on
+        scriptCache.erase(path);
+        return nullptr;
+    }
+
+    std::shared_ptr<CompiledScript> &entry = scriptCache[path];
+
+    const bool unchanged = entry && entry->modified == modified && entry->size == size;
+
+    if (!unchanged || entry->symbolsVersion != symbolsVersion)
+    {
+        MappedFile mapped;
+
+        if (!mapped.open(path))
+        {
+            scriptCache.erase(path);
+            return nullptr;
+        }
+
+        const std::uint64_t contentHash = hashContent(mapped.view());
+
+        // touched but not changed : keep the compiled script
+        if (entry && entry->contentHash == contentHash && entry->symbolsVersion == symbolsVersion)
+        {
+            entry->modified = modified;
+        }
+        else
+        {
+            entry = compileScript(mapped.view());
+            entry->contentHash = contentHash;
+            entry->modified = modified;
+            entry->size = size;
+        }
+    }
+
+    return entry;
+}
+
+inline void Virtuoso::QuakeStyleConsole::requestWait(std::uint64_t frames, std::chrono::steady_clock::duration time)
+{
+    waitRequested = true;
+    waitFrames = frames;
+    waitTime = time;
+}
+
+inline void Virtuoso::QuakeStyleConsole::tick(std::ostream &os)
+{
+    frameNumber++;
+
+    // resuming a script can park it again, so run the ones that were parked when the tick began
+    tickScripts.swap(waitingScripts);
+
+    for (ScriptExecutor &script : tickScripts)
+    {
+        if (script.step(os, std::numeric_limits<std::size_t>::max()))
+        {
+            waitingScripts.push_back(std::move(script));
+        }
+    }
+
+    tickScripts.clear();
+
+    pumpJobs(os);
+
+#ifdef VIRTUOSO_CONSOLE_COROUTINES
+    const auto now = std::chrono::steady_clock::now();
+
+    tickTasks.swap(waitingTasks);
+
+    for (const WaitingTask &task : tickTasks)
+    {
+        if (frameNumber < task.frame || now < task.time)
+        {
+            waitingTasks.push_back(task);
+        }
+        else
+        {
+            tickOutput = &os;
+            task.handle.resume();
+        }
+    }
+
+    tickTasks.clear();
+#endif
+}
+
+template <typename... Args>
+inline void Virtuoso::QuakeStyleConsole::bindAsyncCommand(const std::string &commandName, std::function<void(ConsoleJob &, Args...)> fun, HelpText help)
+{
+    const SymbolID id = symbols.intern(commandName);
+
+    commandSlot(commandName) =
+        [this, id, fun](ConsoleArgs &args, std::ostream &os) {
+            // the job is named by its command line, as typed
+            std::string name(symbols[id].name);
+            if (!args.empty())
+            {
+                name.append(" ").append(args.rest());
+            }
+
+            // arguments are copied into the job, since the tokens they were parsed from only live as long as this line
+            auto launch = [&](const auto &... values) {
+                std::shared_ptr<ConsoleJob> job = startJob(std::move(name), [fun, values...](ConsoleJob &j) { fun(j, values...); });
+                os << "job " << job->id() << " started : " << job->name() << std::endl;
+            };
+
+            if constexpr (sizeof...(Args) == 0)
+            {
+                launch();
+            }
+            else
+            {
+                this->parse<Args...>(args, os, launch);
+            }
+        };
+
+    if (!help.empty())
+    {
+        setHelpTopic(commandName, std::move(help));
+    }
+}
+
+inline std::shared_ptr<Virtuoso::ConsoleJob> Virtuoso::QuakeStyleConsole::startJob(std::string name, std::function<void(ConsoleJob &)> body, bool listed)
+{
+    std::shared_ptr<ConsoleJob> job = std::make_shared<ConsoleJob>(nextJobId++, std::move(name), std::move(body));
+
+    if (listed)
+    {
+        jobs.push_back(job);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+
+        // workers start with the first job, so consoles that never use them don't pay for threads
+        while (jobThreads.size() < jobThreadCount)
+        {
+            jobThreads.emplace_back([this]() { jobWorker(); });
+        }
+
+        jobQueue.push_back(job);
+    }
+
+    jobReady.notify_one();
+
+    return job;
+}
+
+inline bool Virtuoso::QuakeStyleConsole::cancelJob(unsigned id)
+{
+    for (const std::shared_ptr<ConsoleJob> &job : jobs)
+    {
+        if (job->id() == id)
+        {
+            job->cancel();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+inline void Virtuoso::QuakeStyleConsole::jobWorker()
+{
+    for (;;)
+    {
+        std::shared_ptr<ConsoleJob> job;
+
+        {
+            std::unique_lock<std::mutex> lock(jobMutex);
+            jobReady.wait(lock, [this]() { return stopJobs || !jobQueue.empty(); });
+
+            if (stopJobs)
+            {
+                return;
+            }
+
+            job = std::move(jobQueue.front());
+            jobQueue.pop_front();
+            runningJobs.push_back(job);
+        }
+
+        job->run();
+
+        {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            runningJobs.erase(std::find(runningJobs.begin(), runningJobs.end(), job));
+        }
+    }
+}
+
+inline void Virtuoso::QuakeStyleConsole::pumpJobs(std::ostream &os)
+{
+    for (std::size_t i = 0; i < jobs.size();)
+    {
+        ConsoleJob &job = *jobs[i];
+
+        // read the state first : once it's finished, everything it wrote is already in the channel
+        const ConsoleJob::State state = job.state();
+
+        if (job.takeOutput(jobOutput))
+        {
+            os << jobOutput;
+            jobOutput.clear();
+        }
+
+        if (state == ConsoleJob::JOB_DONE || state == ConsoleJob::JOB_CANCELLED)
+        {
+            os << "job " << job.id() << ((state == ConsoleJob::JOB_DONE) ? " finished" : " cancelled") << " after " << job.seconds() << "s : " << job.name() << std::endl;
+            jobs.erase(jobs.begin() + i);
+        }
+        else
+        {
+            i++;
+        }
+    }
+}
+
+inline void Virtuoso::QuakeStyleConsole::commandJobs(ConsoleArgs &args, std::ostream &os)
+{
+    if (args.peek() == "cancel")
+    {
+        args.next();
+
+        unsigned id = 0;
+        if (!ConsoleArgParser<unsigned>::parse(args, id))
+        {
+            raiseError(os) << "type jobs cancel <id>" << std::endl;
+        }
+        else if (!cancelJob(id))
+        {
+            raiseError(os) << "No job " << id << std::endl;
+        }
+
+        return;
+    }
+
+    if (jobs.empty())
+    {
+        os << "no jobs running" << std::endl;
+        return;
+    }
+
+    static const char *stateNames[] = {"queued", "running", "done", "cancelled"};
+
+    for (const std::shared_ptr<ConsoleJob> &job : jobs)
+    {
+        const ConsoleJob::State state = job->state();
+        os << job->id() << " " << ((state == ConsoleJob::JOB_RUNNING && job->cancelled()) ? "cancelling" : stateNames[state]) << " " << job->seconds() << "s : " << job->name() << std::endl;
+    }
+}
+
+inline Virtuoso::ConsoleJob::ConsoleJob(unsigned id, std::string name, std::function<void(ConsoleJob &)> f) : jobId(id),
+                                                                                                           jobName(std::move(name)),
+                                                                                                           body(std::move(f)),
+                                                                                                           buf(*this),
+                                                                                                           stream(&buf)
+{
+}
+
+inline double Virtuoso::ConsoleJob::seconds() const
+{
+    const std::int64_t start = startTicks.load(std::memory_order_relaxed);
+
+    if (!start)
+    {
+        return 0.0;
+    }
+
+    const std::int64_t end = endTicks.load(std::memory_order_relaxed);
+    const std::int64_t now = end ? end : std::chrono::steady_clock::now().time_since_epoch().count();
+
+    return std::chrono::duration<double>(std::chrono::steady_clock::duration(now - start)).count();
+}
+
+inline bool Virtuoso::ConsoleJob::takeOutput(std::string &text)
+{
+    std::lock_guard<std::mutex> lock(channelMutex);
+
+    if (channel.empty())
+    {
+        return false;
+    }
+
+    text.append(channel);
+    channel.clear();
+    return true;
+}
+
+inline void Virtuoso::ConsoleJob::run()
+{
+    if (!cancelled())
+    {
+        startTicks.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+        jobState.store(JOB_RUNNING, std::memory_order_release);
+
+        try
+        {
+            body(*this);
+        }
+        catch (const std::exception &e)
+        {
+            stream << "job " << jobId << " failed : " << e.what() << std::endl;
+        }
+
+        stream.flush();
+        endTicks.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+    }
+
+    jobState.store(cancelled() ? JOB_CANCELLED : JOB_DONE, std::memory_order_release);
+}
+
+inline int Virtuoso::ConsoleJob::ChannelBuf::overflow(int c)
+{
+    if (c != traits_type::eof())
+    {
+        if (used == sizeof(buffer))
+        {
+            sync();
+        }
+
+        buffer[used++] = traits_type::to_char_type(c);
+
+        if (c == '\n')
+        {
+            sync();
+        }
+    }
+
+    return traits_type::not_eof(c);
+}
+
+inline std::streamsize Virtuoso::ConsoleJob::ChannelBuf::xsputn(const char *s, std::streamsize n)
+{
+    const std::size_t count = static_cast<std::size_t>(n);
+
+    if (used + count > sizeof(buffer))
+    {
+        sync();
+    }
+
+    if (count > sizeof(buffer))
+    {
+        std::lock_guard<std::mutex> lock(job.channelMutex);
+        job.channel.append(s, count);
+        return n;
+    }
+
+    std::memcpy(buffer + used, s, count);
+    used += count;
+
+    if (std::memchr(s, '\n', count))
+    {
+        sync();
+    }
+
+    return n;
+}
+
+inline int Virtuoso::ConsoleJob::ChannelBuf::sync()
+{
+    if (used)
+    {
+        std::lock_guard<std::mutex> lock(job.channelMutex);
+        job.channel.append(buffer, used);
+        used = 0;
+    }
+
+    return 0;
+}
+
+inline bool Virtuoso::QuakeStyleConsole::setAlias(std::string_view name, std::string_view body)
+{
+    const SymbolID id = symbols.intern(name);
+
+    auto existing = aliases.find(id);
+
+    if (symbols[id].command && existing == aliases.end())
+    {
+        return false;
+    }
+
+    std::shared_ptr<CompiledAlias> alias = std::make_shared<CompiledAlias>();
+    alias->body.assign(body.data(), body.size());
+
+    const std::string_view text = alias->body;
+
+    ScratchScope scope(*this);
+    std::ostream noOutput(nullptr); // lines with $ aren't tokenized here, so tokenizing has nothing to say
+
+    std::size_t start = 0;
+
+    while (start <= text.size())
+    {
+        // split at ; outside quotes
+        std::size_t end = start;
+        bool quoted = false;
+
+        while (end < text.size() && (quoted || text[end] != ';'))
+        {
+            quoted ^= (text[end] == '"');
+            end++;
+        }
+
+        std::string_view command = text.substr(start, end - start);
+
+        while (command.size() && isConsoleSpace(command.front()))
+        {
+            command.remove_prefix(1);
+        }
+
+        if (command.size() && command[0] != '#')
+        {
+            AliasCommand op;
+            op.text = command;
+            op.firstToken = std::uint32_t(alias->tokens.size());
+
+            if (command.find('$') != command.npos)
+            {
+                op.raw = true;
+            }
+            else
+            {
+                tokenizeLine(command, scope.scratch, noOutput);
+
+                for (std::string_view token : scope.scratch.tokens)
+                {
+                    alias->tokens.push_back(token);
+                }
+
+                op.tokenCount = std::uint32_t(scope.scratch.tokens.size());
+                op.text = scope.scratch.text;
+
+                if (op.tokenCount)
+                {
+                    op.symbol = symbols.find(scope.scratch.tokens[0]);
+                }
+            }
+
+            if (op.raw || op.tokenCount)
+            {
+                alias->commands.push_back(op);
+            }
+        }
+
+        start = end + 1;
+    }
+
+    const bool bound = (existing != aliases.end()) && existing->second && symbols[id].command;
+
+    aliases[id] = std::move(alias);
+
+    // the slot stays put across redefinitions, so an alias can redefine itself while it runs
+    if (!bound)
+    {
+        commandSlot(name) = [this, id](ConsoleArgs &, std::ostream &os) { this->runAlias(id, os); };
+    }
+
+    return true;
+}
+
+inline bool Virtuoso::QuakeStyleConsole::removeAlias(std::string_view name)
+{
+    const SymbolID id = symbols.find(name);
+
+    auto found = aliases.find(id);
+
+    if (id == invalidSymbol || found == aliases.end() || !found->second)
+    {
+        return false;
+    }
+
+    found->second = nullptr;
+
+    if (std::find(aliasStack.begin(), aliasStack.end(), id) == aliasStack.end())
+    {
+        symbols[id].command = nullptr;
+        symbolsVersion++;
+        namesVersion++;
+    }
+
+    return true;
+}
+
+inline const std::string *Virtuoso::QuakeStyleConsole::aliasBody(std::string_view name) const
+{
+    auto found = aliases.find(symbols.find(name));
+
+    return (found != aliases.end() && found->second) ? &found->second->body : nullptr;
+}
+
+inline void Virtuoso::QuakeStyleConsole::runAlias(SymbolID id, std::ostream &os)
+{
+    auto found = aliases.find(id);
+
+    if (found == aliases.end() || !found->second)
+    {
+        raiseError(os) << "Command " << symbols[id].name << " unknown" << std::endl;
+        return;
+    }
+
+    if (std::find(aliasStack.begin(), aliasStack.end(), id) != aliasStack.end())
+    {
+        auto err = raiseError(os);
+        err << "Alias cycle : ";
+
+        for (SymbolID caller : aliasStack)
+        {
+            err << symbols[caller].name << " -> ";
+        }
+
+        err << symbols[id].name << std::endl;
+        return;
+    }
+
+    if (aliasStack.size() >= maxAliasDepth)
+    {
+        raiseError(os) << "Alias " << symbols[id].name << " nested more than " << maxAliasDepth << " deep" << std::endl;
+        return;
+    }
+
+    std::shared_ptr<const CompiledAlias> alias = found->second; // keeps the body alive if the alias redefines itself
+
+    aliasStack.push_back(id);
+
+    for (const AliasCommand &op : alias->commands)
+    {
+        if (op.raw)
+        {
+            ScratchScope scope(*this);
+            executeLine(scope.scratch, op.text, os, EXECUTE_SILENT);
+            continue;
+        }
+
+        ConsoleArgs args(op.text, alias->tokens.data() + op.firstToken, op.tokenCount);
+
+        if (op.symbol != invalidSymbol && symbols[op.symbol].command)
+        {
+            args.next();
+            symbols[op.symbol].command(args, os);
+            os << '\n';
+        }
+
+        executeTokens(args, os); // an unresolved name, or any further commands
+    }
+
+    aliasStack.pop_back();
+}
+
+inline void Virtuoso::QuakeStyleConsole::commandAlias(ConsoleArgs &args, std::ostream &os)
+{
+    if (args.empty())
+    {
+        std::vector<std::pair<std::string_view, const std::string *>> sorted;
+
+        for (const auto &entry : aliases)
+        {
+            if (entry.second)
+            {
+                sorted.emplace_back(symbols[entry.first].name, &entry.second->body);
+            }
+        }
+
+        std::sort(sorted.begin(), sorted.end());
+
+        for (const auto &alias : sorted)
+        {
+            os << alias.first << " : " << *alias.second << std::endl;
+        }
+
+        return;
+    }
+
+    const std::string_view name = args.next();
+
+    if (args.empty())
+    {
+        const std::string *body = aliasBody(name);
+
+        if (body)
+        {
+            os << name << " : " << *body << std::endl;
+        }
+        else
+        {
+            raiseError(os) << "No alias " << name << std::endl;
+        }
+
+        return;
+    }
+
+    std::string_view body = args.rest();
+    args.skipAll();
+
+    if (body.size() >= 2 && body.front() == '"' && body.back() == '"')
+    {
+        body = body.substr(1, body.size() - 2);
+    }
+
+    if (!setAlias(name, body))
+    {
+        raiseError(os) << name << " is already a command" << std::endl;
+    }
+}
+
+inline void Virtuoso::QuakeStyleConsole::commandUnalias(ConsoleArgs &args, std::ostream &os)
+{
+    const std::string_view name = args.next();
+
+    if (!removeAlias(name))
+    {
+        raiseError(os) << "No alias " << name << std::endl;
+    }
+}
+
+inline std::size_t Virtuoso::QuakeStyleConsole::waitingCount() const
+{
+#ifdef VIRTUOSO_CONSOLE_COROUTINES
+    return waitingScripts.size() + waitingTasks.size();
+#else
+    return waitingScripts.size();
+#endif
+}
+
+inline void Virtuoso::QuakeStyleConsole::clearWaiting()
+{
+    waitingScripts.clear();
+
+#ifdef VIRTUOSO_CONSOLE_COROUTINES
+    for (const WaitingTask &task : waitingTasks)
+    {
+        task.handle.destroy();
+    }
+
+    waitingTasks.clear();
+#endif
+}
+
+#ifdef VIRTUOSO_CONSOLE_COROUTINES
+inline void Virtuoso::QuakeStyleConsole::WaitAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+    console.waitingTasks.push_back({handle, console.frameNumber + frames, std::chrono::steady_clock::now() + time});
+}
+#endif
+
+inline std::uint64_t Virtuoso::QuakeStyleConsole::hashContent(std::string_view text)
+{
+    std::uint64_t h = 14695981039346656037ull;
+
+    for (char c : text)
+    {
+        h = (h ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+    }
+
+    return h;
+}
+
+inline std::shared_ptr<Virtuoso::QuakeStyleConsole::CompiledScript> Virtuoso::QuakeStyleConsole::compileScript(std::string_view source)
+{
+    std::shared_ptr<CompiledScript> script = std::make_shared<CompiledScript>();
+
+    script->source.assign(source.data(), source.size());
+    script->symbolsVersion = symbolsVersion;
+
+    std::string_view rest = script->source;
+    std::uint32_t lineNumber = 0;
+
+    ScratchScope scope(*this);
+    std::ostream noOutput(nullptr); // tokenizing only writes when it expands variables, and lines with $ aren't tokenized here
+
+    for (; rest.size(); lineNumber++)
+    {
+        const std::size_t eol = rest.find('\n');
+        std::string_view line = rest.substr(0, eol);
+        rest.remove_prefix(eol == rest.npos ? rest.size() : eol + 1);
+
+        if (!isExecutableLine(line))
+        {
+            continue;
+        }
+
+        while (isConsoleSpace(line[0]))
+        {
+            line.remove_prefix(1);
+        }
+
+        ScriptOp op;
+        op.lineNumber = lineNumber;
+        op.line = line;
+
+        if (line.find('$') != line.npos)
+        {
+            op.kind = ScriptOp::OP_RAW;
+            script->ops.push_back(op);
+            continue;
+        }
+
+        tokenizeLine(line, scope.scratch, noOutput);
+
+        op.text = scope.scratch.text;
+        op.firstToken = std::uint32_t(script->tokens.size());
+        op.tokenCount = std::uint32_t(scope.scratch.tokens.size());
+        script->tokens.insert(script->tokens.end(), scope.scratch.tokens.begin(), scope.scratch.tokens.end());
+
+        const std::string_view *tokens = scope.scratch.tokens.data();
+        const SymbolID id = op.tokenCount ? symbols.find(tokens[0]) : invalidSymbol;
+
+        if (id != invalidSymbol && symbols[id].command)
+        {
+            op.symbol = id;
+        }
+
+        // set <cvar> <number> : resolve the cvar and parse the number now
+        if (id == setSymbol && !setRebound && op.tokenCount == 3)
+        {
+            const SymbolID cvarID = symbols.find(tokens[1]);
+            const CVar *cvar = (cvarID != invalidSymbol) ? &symbols[cvarID].cvar : nullptr;
+            ConsoleArgs literal(tokens[2], tokens + 2, 1);
+            bool parsed = false;
+
+            switch (cvar ? cvar->type : CVAR_NONE)
+            {
+            case CVAR_INT:
+                parsed = ConsoleArgParser<int>::parse(literal, op.literal.i);
+                break;
+            case CVAR_FLOAT:
+                parsed = ConsoleArgParser<float>::parse(literal, op.literal.f);
+                break;
+            case CVAR_DOUBLE:
+                parsed = ConsoleArgParser<double>::parse(literal, op.literal.d);
+                break;
+            case CVAR_BOOL:
+                parsed = ConsoleArgParser<bool>::parse(literal, op.literal.b);
+                break;
+            default:
+                break;
+            }
+
+            if (parsed)
+            {
+                op.kind = ScriptOp::OP_SET;
+                op.symbol = cvarID;
+                op.literalType = cvar->type;
+            }
+        }
+
+        script->ops.push_back(op);
+    }
 
-    /// helper function that takes an input line containing commands and dereferences any console variables whose names appear prefixed by the $ symbol
-    void dereferenceVariables(std::istream &is, std::ostream &os, std::string &str);
+    return script;
+}
 
-    /// assigns the value of a dynamically created console variable using the console's input stream
-    template <class T>
-    void assignDynamicVariable(std::istream &is, std::shared_ptr<T> var);
+inline Virtuoso::QuakeStyleConsole::BatchResult Virtuoso::QuakeStyleConsole::runCompiledScript(const std::shared_ptr<CompiledScript> &script, std::ostream &os, unsigned flags)
+{
+    const auto start = std::chrono::steady_clock::now();
 
-    /// writes a dynamically created console variable to the console output
-    template <class T>
-    void writeDynamicVariable(std::ostream &os, std::shared_ptr<T> var);
+    BatchResult result;
 
-    /// bind dynamically created console variable to the variable table and set the associated help string
-    template <class T>
-    void bindDynamicCVar(const std::string &var, const T &value, const std::string &help);
+    const std::vector<ScriptOp> &ops = script->ops;
 
-    /// bind dynamically created console variable to the variable table.
-    template <class T>
-    void bindDynamicCVar(const std::string &var, const T &valueIn);
+    const std::size_t historySkip = (ops.size() > history_buffer.capacity()) ? ops.size() - history_buffer.capacity() : 0;
 
-  public:
-    /// Dynamic variables are string-based variables that can be created, assigned, and dereferenced from the console itself rather than C++ code
-    struct DynamicVariable : public std::string
+    ScratchScope scope(*this);
+
+    for (std::size_t i = 0; i < ops.size(); i++)
     {
-    };
+        const ScriptOp &op = ops[i];
+        const unsigned lineFlags = (result.lines < historySkip) ? (flags & ~EXECUTE_HISTORY) : flags;
+        const std::uint64_t errorsBefore = errorCount;
 
-    // -----------------------------------------------------------------------------
-    // EndOfLineEscapeStreamScope : by Steve132
-    // For wrapping the output of an ostream push sequence << in a begin / end tag
-    // Used for console output formatting
-    // -----------------------------------------------------------------------------
-    typedef std::pair<std::string, std::string> EndOfLineEscapeTag;
+        result.lines++;
 
-    struct EndOfLineEscapeStreamScope
-    {
-      protected:
-        EndOfLineEscapeTag tag;
-        std::ostream &os;
+        waitRequested = false;
 
-        EndOfLineEscapeStreamScope(const EndOfLineEscapeTag &ttag, std::ostream &tout) : tag(ttag),
-                                                                                         os(tout)
-        {
-            os << tag.first; //you can overload this for custom ostream types with a different color interface
-            //this might also have a stack interface for if you need multiple resets
-        }
+        const std::size_t parkedBefore = waitingScripts.size();
 
-        friend EndOfLineEscapeStreamScope operator<<(std::ostream &out, const EndOfLineEscapeTag &tg);
+        runScriptOp(*script, op, scope.scratch, os, lineFlags);
 
-      public:
-        template <class T>
-        EndOfLineEscapeStreamScope &operator<<(T &&t)
+        if (!recordBatchErrors(result, errorsBefore, op.lineNumber, flags))
         {
-            os << std::forward<T>(t);
-            return *this;
+            break;
         }
 
-        EndOfLineEscapeStreamScope &operator<<(std::ostream &(&M)(std::ostream &))
+        if (waitRequested || waitingScripts.size() > parkedBefore)
         {
-            M(os);
-            return *this;
-        }
+            // the rest runs from tick(), after anything a nested runFile parked.  This call's summary covers the lines run so far
+            if (i + 1 < ops.size())
+            {
+                ScriptExecutor rest(*this, script, flags & ~EXECUTE_SUMMARY, i + 1);
+                rest.parkOnWait(parkedBefore);
+                waitingScripts.push_back(std::move(rest));
+            }
 
-        ~EndOfLineEscapeStreamScope()
-        {
-            os << tag.second;
+            // left set, so a script that ran this one parks its own rest behind it
+            waitRequested = true;
+            break;
         }
-    };
-};
-
-inline Virtuoso::QuakeStyleConsole::EndOfLineEscapeStreamScope operator<<(std::ostream &os, const Virtuoso::QuakeStyleConsole::EndOfLineEscapeTag &tg)
-{
-    return Virtuoso::QuakeStyleConsole::EndOfLineEscapeStreamScope(tg, os);
-}
-
-} // namespace Virtuoso
+    }
 
-// -----------------------------------------------------------------------------
-// QuakeStyleConsole : Method Implementations below
-// -----------------------------------------------------------------------------
+    finishBatch(result, start, os, flags);
 
-template <class T>
-inline T Virtuoso::QuakeStyleConsole::makeTemp()
-{
-    T temp{};
-    return temp;
+    return result;
 }
 
-template <typename... Args>
-inline void Virtuoso::QuakeStyleConsole::conditionalExecute(std::istream &is, std::ostream &os, std::function<void(Args...)> f, const Args &... args)
+inline void Virtuoso::QuakeStyleConsole::runScriptOp(const CompiledScript &script, const ScriptOp &op, LineScratch &scratch, std::ostream &os, unsigned lineFlags)
 {
-    if (is.fail())
+    if (op.kind == ScriptOp::OP_RAW)
     {
-        os << error() << "Syntax error in function arguments." << std::endl;
-        is.clear();
+        executeLine(scratch, op.line, os, lineFlags);
     }
     else
     {
-        f(args...);
+        if (lineFlags & EXECUTE_HISTORY)
+        {
+            history_buffer.emplace(op.line);
+        }
+
+        if (lineFlags & EXECUTE_ECHO)
+        {
+            os << echo() << op.line << std::endl;
+        }
+
+        ConsoleArgs args(op.text, script.tokens.data() + op.firstToken, op.tokenCount);
+
+        CVar *cvar = (op.kind == ScriptOp::OP_SET) ? &symbols[op.symbol].cvar : nullptr;
+
+        // the cvar could have been rebound as another type since compiling; then it goes through set like any other line
+        if (cvar && cvar->type == op.literalType && !(cvar->flags & CVAR_READONLY))
+        {
+            switch (op.literalType)
+            {
+            case CVAR_INT:
+                *static_cast<int *>(cvar->data) = op.literal.i;
+                break;
+            case CVAR_FLOAT:
+                *static_cast<float *>(cvar->data) = op.literal.f;
+                break;
+            case CVAR_DOUBLE:
+                *static_cast<double *>(cvar->data) = op.literal.d;
+                break;
+            case CVAR_BOOL:
+                *static_cast<bool *>(cvar->data) = op.literal.b;
+                break;
+            default:
+                break;
+            }
+
+            cvarChanged(*cvar);
+            os << '\n';
+        }
+        else if (!cvar && op.symbol != invalidSymbol && symbols[op.symbol].command)
+        {
+            args.next();
+            symbols[op.symbol].command(args, os);
+            os << '\n';
+
+            executeTokens(args, os); // any further commands on the line
+        }
+        else
+        {
+            executeTokens(args, os);
+        }
     }
 }
 
-template <typename FirstType>
-inline void Virtuoso::QuakeStyleConsole::populateTemps(std::istream &is, FirstType &in)
+inline Virtuoso::QuakeStyleConsole::ScriptExecutor Virtuoso::QuakeStyleConsole::startScript(const std::string &path, std::ostream &output, unsigned flags)
 {
-    is >> in;
+    std::shared_ptr<CompiledScript> script = cachedScript(path);
+
+    if (!script)
+    {
+        // pipes and other files that can't be mapped are read as a stream and compiled without caching
+        std::ifstream file(path, std::ios::binary);
+
+        if (!file)
+        {
+            ScriptExecutor failed;
+            raiseError(output) << "Unable to open file : " << path << std::endl;
+            failed.batch.errors = 1;
+            return failed;
+        }
+
+        std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        script = compileScript(text);
+    }
+
+    return ScriptExecutor(*this, std::move(script), flags);
 }
 
-//variadic template that recursively parses our function arguments in order
-template <typename FirstType, typename... Args>
-inline void Virtuoso::QuakeStyleConsole::populateTemps(std::istream &is, FirstType &in, Args &... Temps)
+inline Virtuoso::QuakeStyleConsole::ScriptExecutor Virtuoso::QuakeStyleConsole::startScriptText(std::string_view text, unsigned flags)
 {
-    is >> in;
-    populateTemps(is, Temps...);
+    return ScriptExecutor(*this, compileScript(text), flags);
 }
 
-template <typename... Args>
-inline void Virtuoso::QuakeStyleConsole::goPopulateTemps(std::istream &is, Args &... temps)
+inline Virtuoso::QuakeStyleConsole::ScriptExecutor::ScriptExecutor(QuakeStyleConsole &con, std::shared_ptr<const CompiledScript> compiled, unsigned executeFlags, std::size_t first) : console(&con),
+                                                                                                                                                                            script(std::move(compiled)),
+                                                                                                                                                                            next(first),
+                                                                                                                                                                            flags(executeFlags)
 {
-    populateTemps(is, temps...);
+    const std::size_t capacity = console->history_buffer.capacity();
+    const std::size_t remaining = script->ops.size() - next;
+    historySkip = (remaining > capacity) ? remaining - capacity : 0;
 }
 
-template <typename... Args>
-inline void Virtuoso::QuakeStyleConsole::populateAndExecute(std::istream &is, std::ostream &os, std::function<void(Args...)> f,
-                                                            typename std::remove_const<typename std::remove_reference<Args>::type>::type... temps)
+inline bool Virtuoso::QuakeStyleConsole::ScriptExecutor::waiting() const
 {
-    goPopulateTemps<typename std::remove_const<typename std::remove_reference<Args>::type>::type...>(is, temps...);
+    if (!nested.empty())
+    {
+        return nested.front().waiting();
+    }
 
-    conditionalExecute<Args...>(is, os, f, temps...);
+    return console && (console->frameNumber < resumeFrame || std::chrono::steady_clock::now() < resumeTime);
 }
 
-//function that gets bound as type void to the console with a second function object that may have multiple arguments of various types
-//this function gets called when the user enters the function name into the console.
-template <typename... Args>
-inline void Virtuoso::QuakeStyleConsole::parse(std::istream &is, std::ostream &os, std::function<void(Args...)> f)
+inline void Virtuoso::QuakeStyleConsole::ScriptExecutor::parkOnWait(std::size_t firstParked)
 {
+    std::vector<ScriptExecutor> &parked = console->waitingScripts;
 
-    //first we have to create a bunch of temp variables and pass them into the populateAndExecute function
-    //the temp variables are needed to store the result.  There's no guarantee in c++ for argument evaluation order, so we can't just
-    //skip the intermediate step of passing constructed temps into a second function
-    populateAndExecute<Args...>(is, os, f, (makeTemp<typename std::remove_const<typename std::remove_reference<Args>::type>::type>())...);
+    if (parked.size() > firstParked)
+    {
+        nested.insert(nested.end(), std::make_move_iterator(parked.begin() + firstParked), std::make_move_iterator(parked.end()));
+        parked.erase(parked.begin() + firstParked, parked.end());
+        return;
+    }
+
+    resumeFrame = console->frameNumber + console->waitFrames;
+    resumeTime = std::chrono::steady_clock::now() + console->waitTime;
 }
 
-inline void Virtuoso::QuakeStyleConsole::bindCommand(const std::string &str, void (*fptr)(void), const std::string &help)
+inline bool Virtuoso::QuakeStyleConsole::ScriptExecutor::step(std::ostream &os, std::size_t maxLines, std::chrono::microseconds timeBudget)
 {
-    commandTable[str] = [fptr](std::istream &, std::ostream &) { fptr(); };
+    if (done())
+    {
+        return false;
+    }
 
-    if (help.length())
-        setHelpTopic(str, help);
-}
+    // scripts this one ran finish first
+    while (!nested.empty())
+    {
+        if (nested.front().step(os, maxLines, timeBudget))
+        {
+            return true;
+        }
 
-template <typename... Args>
-inline void Virtuoso::QuakeStyleConsole::bindCommand(const std::string &str, void (*fptr)(Args...), const std::string &help)
-{
-    commandTable[str] =
-        [this, fptr](std::istream &is, std::ostream &os) {
-            auto fo = std::function<void(Args...)>(fptr);
-            this->parse<Args...>(is, os, fo);
-        };
+        nested.erase(nested.begin());
+    }
 
-    if (help.length())
-        setHelpTopic(str, help);
-}
+    if (waiting())
+    {
+        return true;
+    }
 
-template <typename... Args>
-inline void Virtuoso::QuakeStyleConsole::bindCommand(const std::string &str, std::function<void(Args...)> fun, const std::string &help)
-{
-    commandTable[str] =
-        [this, fun](std::istream &is, std::ostream &os) {
-            this->parse<Args...>(is, os, fun);
-        };
+    const auto start = std::chrono::steady_clock::now();
+    const auto deadline = (timeBudget == std::chrono::microseconds::max()) ? std::chrono::steady_clock::time_point::max() : start + timeBudget;
+
+    ScratchScope scope(*console);
+
+    for (std::size_t count = 0; count < maxLines && next < script->ops.size() && !cancelled; count++)
+    {
+        // checked after the first line, so every step makes progress however small the budget
+        if (count && std::chrono::steady_clock::now() >= deadline)
+        {
+            break;
+        }
+
+        const ScriptOp &op = script->ops[next++];
+        const unsigned lineFlags = (batch.lines < historySkip) ? (flags & ~EXECUTE_HISTORY) : flags;
+        const std::uint64_t errorsBefore = console->errorCount;
+
+        batch.lines++;
+
+        console->waitRequested = false;
+
+        const std::size_t parkedBefore = console->waitingScripts.size();
+
+        console->runScriptOp(*script, op, scope.scratch, os, lineFlags);
+
+        if (!console->recordBatchErrors(batch, errorsBefore, op.lineNumber, flags))
+        {
+            break;
+        }
+
+        if (console->waitRequested || console->waitingScripts.size() > parkedBefore)
+        {
+            parkOnWait(parkedBefore);
+            break;
+        }
+    }
+
+    // the summary is only written once, by the step that finishes the script
+    console->finishBatch(batch, start, os, done() ? flags : (flags & ~EXECUTE_SUMMARY));
 
-    if (help.length())
-        setHelpTopic(str, help);
+    return !done();
 }
 
-inline void Virtuoso::QuakeStyleConsole::bindCommand(const std::string &str, ConsoleFunc fun, const std::string &help)
+inline Virtuoso::QuakeStyleConsole::BatchResult Virtuoso::QuakeStyleConsole::executeBatch(std::string_view buffer, std::ostream &output, unsigned flags)
 {
-    if (help.length())
-        setHelpTopic(str, help);
+    return runBatch(
+        [buffer](const auto &f) {
+            std::string_view rest = buffer;
 
-    commandTable[str] = fun;
+            while (rest.size())
+            {
+                const std::size_t eol = rest.find('\n');
+
+                if (!f(rest.substr(0, eol)) || eol == rest.npos)
+                {
+                    return;
+                }
+
+                rest.remove_prefix(eol + 1);
+            }
+        },
+        output, flags);
 }
 
-inline void Virtuoso::QuakeStyleConsole::setHelpTopic(const std::string &str, const std::string &data)
+inline Virtuoso::QuakeStyleConsole::BatchResult Virtuoso::QuakeStyleConsole::executeBatch(const std::string_view *lines, std::size_t count, std::ostream &output, unsigned flags)
 {
-    helpTable[str] = data;
+    return runBatch(
+        [lines, count](const auto &f) {
+            for (std::size_t i = 0; i < count && f(lines[i]); i++)
+            {
+            }
+        },
+        output, flags);
 }
 
-template <class T>
-inline void Virtuoso::QuakeStyleConsole::bindCVar(const std::string &str, T &var, const std::string &help)
+inline Virtuoso::QuakeStyleConsole::BatchResult Virtuoso::QuakeStyleConsole::executeBatch(std::istream &input, std::ostream &output, unsigned flags)
 {
-    cvarReadFTable[str] =
-        [this, &var](std::istream &is, std::ostream &os) {
-            this->setCvar<T>(is, os, &var);
-        };
+    return runBatch(
+        [&input](const auto &f) {
+            std::vector<char> block(1u << 16);
+            std::string partial; // a line split across blocks
 
-    cvarPrintFTable[str] =
-        [this, &var](std::istream &is, std::ostream &os) {
-            this->printCvar<T>(os, &var);
-        };
+            while (input.read(block.data(), std::streamsize(block.size())) || input.gcount() > 0)
+            {
+                std::string_view rest(block.data(), std::size_t(input.gcount()));
+                std::size_t eol;
+
+                while ((eol = rest.find('\n')) != rest.npos)
+                {
+                    if (partial.size())
+                    {
+                        partial.append(rest.substr(0, eol));
+
+                        if (!f(std::string_view(partial)))
+                        {
+                            return;
+                        }
+
+                        partial.clear();
+                    }
+                    else if (!f(rest.substr(0, eol)))
+                    {
+                        return;
+                    }
+
+                    rest.remove_prefix(eol + 1);
+                }
+
+                partial.append(rest);
+            }
 
-    if (help.length())
-        setHelpTopic(str, help);
+            if (partial.size())
+            {
+                f(std::string_view(partial));
+            }
+        },
+        output, flags, false);
 }
 
-template <class T>
-void Virtuoso::QuakeStyleConsole::setCvar(std::istream &is, std::ostream &os, T *var)
+inline Virtuoso::QuakeStyleConsole::BatchResult Virtuoso::QuakeStyleConsole::executeBatch(const std::vector<std::string> &lines, std::ostream &output, unsigned flags)
 {
-    T tmp; ///temp argument is a necessity; without it we risk corruption of our variable value if there is a parse error.  Should be no issue unless someone is using this to parse a ginormous structure or copy construction invokes a state change.
+    return runBatch(
+        [&lines](const auto &f) {
+            for (const std::string &line : lines)
+            {
+                if (!f(line))
+                {
+                    return;
+                }
+            }
+        },
+        output, flags);
+}
+
+inline void Virtuoso::QuakeStyleConsole::commandHelp(ConsoleArgs &args, std::ostream &os)
+{
+    const char *genericHelp = "Type 'help' followed by the name of a command or variable to get help on that topic if available."
+                              "\nType listCmd, listCVars, and listHelp to print lists of the available commands, variables, and help topics."
+                              "\nUse $<varname> to dereference a variable in a command argument list and use # to comment the rest of a line";
 
-    is >> tmp;
+    std::string_view x;
 
-    if (is.fail())
+    if (args.next(x))
     {
-        os << error() << "SYNTAX ERROR IN VARIABLE PARSER" << std::endl;
-        is.clear();
+        const std::string_view text = helpText(x);
+
+        if (text.size())
+        {
+            os << text << std::endl;
+        }
+        else
+        {
+            raiseError(os) << "No help available for topic: " << x << std::endl;
+        }
     }
     else
     {
-        *var = tmp;
+        os << genericHelp << std::endl;
     }
 }
 
-template <class T>
-inline void Virtuoso::QuakeStyleConsole::printCvar(std::ostream &os, T *var)
+inline void Virtuoso::QuakeStyleConsole::listHelp(std::ostream &os)
 {
-    os << *var << std::endl;
-}
+    mergeStaticSymbols();
 
-template <class T>
-inline void Virtuoso::QuakeStyleConsole::assignDynamicVariable(std::istream &is, std::shared_ptr<T> var)
-{
-    is >> (*var);
-}
+    os << "\nAvailable help topics:";
 
-template <class T>
-inline void Virtuoso::QuakeStyleConsole::writeDynamicVariable(std::ostream &os, std::shared_ptr<T> var)
-{
-    const T &deref = *(var);
-    os << deref;
+    for (HelpTable::const_iterator it = getHelpTable().begin(); it != getHelpTable().end(); it++)
+    {
+        os << "\n"
+           << it->first;
+    }
+
+    os << std::endl;
 }
 
-template <class T>
-inline void Virtuoso::QuakeStyleConsole::bindDynamicCVar(const std::string &var, const T &value, const std::string &help)
+inline void Virtuoso::QuakeStyleConsole::listCmd(std::ostream &os)
 {
-    helpTable[var] = help;
-    bindDynamicCVar(var, value);
+    mergeStaticSymbols();
+
+    os << "\nAvailable commands:";
+
+    for (CommandTable::const_iterator it = getCommandTable().begin(); it != getCommandTable().end(); it++)
+    {
+        os << "\n"
+           << it->first;
+    }
+
+    os << std::endl;
 }
 
-template <class T>
-inline void Virtuoso::QuakeStyleConsole::bindDynamicCVar(const std::string &var, const T &valueIn)
+inline void Virtuoso::QuakeStyleConsole::listCVars(std::ostream &os)
 {
-    std::shared_ptr<T> ptr(new T(valueIn));
+    mergeStaticSymbols();
 
-    cvarReadFTable[var] =
-        [this, ptr](std::istream &is, std::ostream &os) {
-            this->assignDynamicVariable<T>(is, ptr);
-        };
+    os << "\nBound console variables:";
 
-    cvarPrintFTable[var] =
-        [this, ptr](std::istream &is, std::ostream &os) {
-            this->writeDynamicVariable<T>(os, ptr);
-        };
+    for (CVarReadTable::const_iterator it = getCVarReadTable().begin(); it != getCVarReadTable().end(); it++)
+    {
+        os << "\n"
+           << it->first;
+    }
+
+    os << std::endl;
 }
 
-inline void Virtuoso::QuakeStyleConsole::executeUntilEOF(std::istream &f, std::ostream &output)
+inline void Virtuoso::QuakeStyleConsole::commandSet(ConsoleArgs &args, std::ostream &os)
 {
-    while (!f.eof())
+    std::string_view x;
+
+    if (!args.next(x))
     {
-        commandExecute(f, output);
+        raiseError(os) << "Syntax error parsing argument" << std::endl;
+        return;
+    }
+
+    CVar *cvar = lookupCVar(x);
+
+    if (!cvar)
+    {
+        raiseError(os) << "Variable " << x << " unknown." << std::endl;
+    }
+    else if (cvar->flags & CVAR_READONLY)
+    {
+        raiseError(os) << "Variable " << x << " is read only." << std::endl;
+    }
+    else
+    {
+        readCVar(*cvar, args, os);
     }
 }
 
-inline void Virtuoso::QuakeStyleConsole::executeFile(const std::string &x, std::ostream &output)
+/// the function associated with built in command "echo", which prints the value of a cvar if it is bound. if not, reports an error.
+inline void Virtuoso::QuakeStyleConsole::commandEcho(ConsoleArgs &args, std::ostream &os)
 {
-    std::ifstream f(x);
+    std::string_view x;
 
-    if (!f.is_open())
+    if (!args.next(x))
+    {
+        raiseError(os) << "Syntax error parsing argument." << std::endl;
+        return;
+    }
+
+    if (const CVar *cvar = lookupCVar(x))
     {
-        output << error() << "Unable to open file : " << x << std::endl;
+        writeCVar(*cvar, os);
     }
     else
     {
-        executeUntilEOF(f, output);
+        raiseError(os) << "Variable " << x << " unknown." << std::endl;
+    }
+}
+
+inline std::uint32_t Virtuoso::QuakeStyleConsole::SymbolTable::hash(std::string_view name)
+{
+    std::uint32_t h = 2166136261u;
+
+    for (char c : name)
+    {
+        h ^= static_cast<unsigned char>(c);
+        h *= 16777619u;
     }
 
-    f.close();
+    return h;
 }
 
-inline void Virtuoso::QuakeStyleConsole::commandHelp(std::istream &is, std::ostream &os)
+inline Virtuoso::QuakeStyleConsole::SymbolID Virtuoso::QuakeStyleConsole::SymbolTable::find(std::string_view name) const
 {
-    const char *genericHelp = "Type 'help' followed by the name of a command or variable to get help on that topic if available."
-                              "\nType listCmd, listCVars, and listHelp to print lists of the available commands, variables, and help topics."
-                              "\nUse $<varname> to dereference a variable in a command argument list and use # to comment the rest of a line";
+    if (slots.empty())
+    {
+        return invalidSymbol;
+    }
 
-    std::string x;
+    const std::uint32_t h = hash(name);
+    const std::size_t mask = slots.size() - 1;
 
-    if (is >> x)
+    for (std::size_t i = h & mask;; i = (i + 1) & mask)
     {
-        HelpTable::const_iterator it = helpTable.find(x);
+        const Slot &slot = slots[i];
 
-        if (it != helpTable.end())
+        if (slot.id == invalidSymbol)
         {
-            os << (it->second) << std::endl;
+            return invalidSymbol;
         }
-        else
+
+        if (slot.hash == h && symbols[slot.id].name == name)
         {
-            os << error() << "No help available for topic: " << x << std::endl;
+            return slot.id;
         }
     }
-    else
-    {
-        os << genericHelp << std::endl;
-    }
 }
 
-inline void Virtuoso::QuakeStyleConsole::listHelp(std::ostream &os) const
+inline Virtuoso::QuakeStyleConsole::SymbolID Virtuoso::QuakeStyleConsole::SymbolTable::intern(std::string_view name)
 {
-    os << "\nAvailable help topics:";
+    SymbolID id = find(name);
 
-    for (HelpTable::const_iterator it = helpTable.begin(); it != helpTable.end(); it++)
+    if (id != invalidSymbol)
     {
-        os << "\n"
-           << it->first;
+        return id;
     }
 
-    os << std::endl;
-}
+    if ((symbols.size() + 1) * 2 > slots.size())
+    {
+        rehash(slots.size() ? slots.size() * 2 : 64u);
+    }
 
-inline void Virtuoso::QuakeStyleConsole::listCmd(std::ostream &os) const
-{
-    os << "\nAvailable commands:";
+    id = static_cast<SymbolID>(symbols.size());
+
+    symbols.emplace_back();
+    symbols.back().name = storeName(name);
+    symbols.back().hash = hash(name);
 
-    for (CommandTable::const_iterator it = commandTable.begin(); it != commandTable.end(); it++)
+    const std::size_t mask = slots.size() - 1;
+    std::size_t i = symbols.back().hash & mask;
+
+    while (slots[i].id != invalidSymbol)
     {
-        os << "\n"
-           << it->first;
+        i = (i + 1) & mask;
     }
 
-    os << std::endl;
+    slots[i].hash = symbols.back().hash;
+    slots[i].id = id;
+
+    unsortedNames.push_back(id);
+
+    return id;
 }
 
-inline void Virtuoso::QuakeStyleConsole::listCVars(std::ostream &os) const
+inline bool Virtuoso::QuakeStyleConsole::SymbolTable::nameLess(std::string_view a, std::string_view b)
 {
-    os << "\nBound console variables:";
+    const std::size_t n = std::min(a.size(), b.size());
 
-    for (CVarReadTable::const_iterator it = cvarReadFTable.begin(); it != cvarReadFTable.end(); it++)
+    for (std::size_t i = 0; i < n; i++)
     {
-        os << "\n"
-           << it->first;
+        const int x = std::tolower(static_cast<unsigned char>(a[i]));
+        const int y = std::tolower(static_cast<unsigned char>(b[i]));
+
+        if (x != y)
+        {
+            return x < y;
+        }
     }
 
-    os << std::endl;
+    return (a.size() != b.size()) ? a.size() < b.size() : a < b;
 }
 
-inline void Virtuoso::QuakeStyleConsole::commandSet(std::istream &is, std::ostream &os)
+inline std::size_t Virtuoso::QuakeStyleConsole::SymbolTable::commonPrefix(std::string_view a, std::string_view b)
 {
-    std::string x;
+    const std::size_t n = std::min(a.size(), b.size());
+    std::size_t i = 0;
 
-    if (!(is >> x))
+    while (i < n && std::tolower(static_cast<unsigned char>(a[i])) == std::tolower(static_cast<unsigned char>(b[i])))
     {
-        os << error() << "Syntax error parsing argument" << std::endl;
-        return;
+        i++;
     }
 
-    CVarReadTable::iterator it = cvarReadFTable.find(x);
+    return i;
+}
+
+inline std::pair<const Virtuoso::QuakeStyleConsole::SymbolID *, const Virtuoso::QuakeStyleConsole::SymbolID *>
+Virtuoso::QuakeStyleConsole::SymbolTable::prefixRange(std::string_view prefix)
+{
+    auto less = [this](SymbolID a, SymbolID b) { return nameLess(symbols[a].name, symbols[b].name); };
 
-    if (it != cvarReadFTable.end())
+    if (unsortedNames.size())
     {
-        it->second(is, os);
+        std::sort(unsortedNames.begin(), unsortedNames.end(), less);
+
+        const std::size_t middle = sortedNames.size();
+        sortedNames.insert(sortedNames.end(), unsortedNames.begin(), unsortedNames.end());
+        std::inplace_merge(sortedNames.begin(), sortedNames.begin() + middle, sortedNames.end(), less);
+
+        unsortedNames.clear();
+        lastValid = false;
     }
-    else
+
+    // compares a name cut to the length of the prefix against the prefix, ignoring case
+    auto comparePrefix = [this, prefix](SymbolID id) {
+        const std::string_view name = symbols[id].name;
+        const std::size_t n = std::min(name.size(), prefix.size());
+
+        for (std::size_t i = 0; i < n; i++)
+        {
+            const int x = std::tolower(static_cast<unsigned char>(name[i]));
+            const int y = std::tolower(static_cast<unsigned char>(prefix[i]));
+
+            if (x != y)
+            {
+                return x < y ? -1 : 1;
+            }
+        }
+
+        return (name.size() < prefix.size()) ? -1 : 0;
+    };
+
+    const SymbolID *begin = sortedNames.data();
+    const SymbolID *end = begin + sortedNames.size();
+
+    // every name starting with prefix also starts with any shorter prefix of it, so typing one more letter narrows the last range
+    if (lastValid && prefix.size() >= lastPrefix.size() && commonPrefix(prefix, lastPrefix) == lastPrefix.size())
     {
-        os << error() << "Variable " << x << " unknown." << std::endl;
+        end = sortedNames.data() + lastLast;
+        begin = sortedNames.data() + lastFirst;
     }
+
+    const SymbolID *first = std::partition_point(begin, end, [&](SymbolID id) { return comparePrefix(id) < 0; });
+    const SymbolID *last = std::partition_point(first, end, [&](SymbolID id) { return comparePrefix(id) == 0; });
+
+    lastPrefix.assign(prefix);
+    lastFirst = first - sortedNames.data();
+    lastLast = last - sortedNames.data();
+    lastValid = true;
+
+    return {first, last};
 }
 
-/// the function associated with built in command "echo", which prints the value of a cvar if it is bound. if not, reports an error.
-inline void Virtuoso::QuakeStyleConsole::commandEcho(std::istream &is, std::ostream &os)
+inline std::string_view Virtuoso::QuakeStyleConsole::SymbolTable::storeName(std::string_view name)
 {
-    std::string x;
+    const std::size_t bytes = name.size() + 1;
 
-    if (!(is >> x))
+    if (nameBlockUsed + bytes > nameBlockSize)
     {
-        os << error() << "Syntax error parsing argument." << std::endl;
-        return;
+        // names too big for a block get a block of their own
+        nameBlocks.emplace_back(new char[std::max(bytes, nameBlockSize)]);
+        nameBlockUsed = 0;
     }
 
-    CVarPrintTable::iterator it = cvarPrintFTable.find(x);
+    char *dst = nameBlocks.back().get() + nameBlockUsed;
 
-    if (it != cvarPrintFTable.end())
-    {
-        (it->second)(is, os);
-    }
-    else
+    name.copy(dst, name.size());
+    dst[name.size()] = '\0';
+
+    nameBlockUsed += bytes;
+
+    return std::string_view(dst, name.size());
+}
+
+inline void Virtuoso::QuakeStyleConsole::SymbolTable::rehash(std::size_t slotCount)
+{
+    std::vector<Slot> newSlots(slotCount);
+    const std::size_t mask = slotCount - 1;
+
+    for (SymbolID id = 0; id < symbols.size(); id++)
     {
-        os << error() << "Variable " << x << " unknown." << std::endl;
+        std::size_t i = symbols[id].hash & mask;
+
+        while (newSlots[i].id != invalidSymbol)
+        {
+            i = (i + 1) & mask;
+        }
+
+        newSlots[i].hash = symbols[id].hash;
+        newSlots[i].id = id;
     }
+
+    slots.swap(newSlots);
+}
+
+inline Virtuoso::QuakeStyleConsole::ScratchScope::ScratchScope(QuakeStyleConsole &con)
+    : console(con),
+      scratch((con.lineScratch.size() <= con.executionDepth) ? con.lineScratch.emplace_back() : con.lineScratch[con.executionDepth])
+{
+    console.executionDepth++;
 }
 
-inline void Virtuoso::QuakeStyleConsole::commandExecute(const std::string &str, std::ostream &output)
+inline void Virtuoso::QuakeStyleConsole::commandExecute(std::string_view str, std::ostream &output, unsigned flags)
 {
-    std::stringstream lineStream;
-    lineStream.str(str);
-    commandExecute(lineStream, output);
+    while (str.size())
+    {
+        const std::size_t eol = str.find('\n');
+        const std::string_view line = str.substr(0, eol);
+
+        {
+            ScratchScope scope(*this);
+            executeLine(scope.scratch, line, output, flags);
+        }
+
+        if (eol == str.npos)
+        {
+            break;
+        }
+
+        str.remove_prefix(eol + 1);
+    }
 }
 
-///reads a string from the input stream and executes the command associated with it, if there is one.  if not, reports an error.
-inline void Virtuoso::QuakeStyleConsole::commandExecute(std::istream &is, std::ostream &os)
+///reads a line from the input stream and executes the commands in it.
+inline void Virtuoso::QuakeStyleConsole::commandExecute(std::istream &is, std::ostream &os, unsigned flags)
 {
     char ch;
     while (!is.eof())
@@ -739,11 +6299,10 @@ inline void Virtuoso::QuakeStyleConsole::commandExecute(std::istream &is, std::o
         }
         else if (ch == '#')
         {
-            std::string tmp;
-            getline(is, tmp);
+            is.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
             return;
         } //if newline we will not parse anything else
-        else if (std::isspace(ch))
+        else if (isConsoleSpace(ch))
         {
             is.get(ch);
             continue;
@@ -754,41 +6313,198 @@ inline void Virtuoso::QuakeStyleConsole::commandExecute(std::istream &is, std::o
         }
     }
 
-    std::stringstream lineStream;
-    {
-        std::string lineTemp;
+    ScratchScope scope(*this);
 
-        getline(is, lineTemp);
+    getline(is, scope.scratch.input);
 
-        history_buffer.push(lineTemp);
+    executeLine(scope.scratch, scope.scratch.input, os, flags);
+}
+
+inline bool Virtuoso::QuakeStyleConsole::executeLine(LineScratch &scratch, std::string_view line, std::ostream &os, unsigned flags)
+{
+    std::size_t first = 0;
+
+    while (first < line.size() && isConsoleSpace(line[first]))
+    {
+        first++;
+    }
 
-        os << echo() << lineTemp << std::endl;
+    line.remove_prefix(first);
+
+    if (line.empty() || line[0] == '#')
+    {
+        return false;
+    }
 
-        dereferenceVariables(is, os, lineTemp);
+    if (flags & EXECUTE_HISTORY)
+    {
+        history_buffer.emplace(line);
+    }
 
-        lineStream.str(lineTemp); ///\todo this constrains us to a single line.  way to go later might be to require user or
-        ///generated command parser to return string that was parsed
+    if (flags & EXECUTE_ECHO)
+    {
+        os << echo() << line << std::endl;
     }
 
-    std::string x;
+    tokenizeLine(line, scratch, os);
+
+    ConsoleArgs args(scratch.text, scratch.tokens.data(), scratch.tokens.size());
+
+    executeTokens(args, os);
+
+    return true;
+}
+
+///reads a command name from the arguments and executes the command associated with it, if there is one.  if not, reports an error.
+inline void Virtuoso::QuakeStyleConsole::executeTokens(ConsoleArgs &args, std::ostream &os)
+{
+    std::string_view x;
 
-    while (lineStream >> x)
+    while (args.next(x))
     {
-        CommandTable::const_iterator it = commandTable.find(x);
+        SymbolID id = symbols.find(x);
 
-        if (it == commandTable.end())
+        if (id != invalidSymbol && symbols[id].command)
+        {
+            symbols[id].command(args, os); //execute the command
+        }
+        else if (const StaticSymbol *s = StaticSymbolRegistry::find(x); s && s->command)
         {
-            os << error() << "Command " << x << " unknown" << std::endl;
+            s->command(*this, args, os);
         }
         else
         {
-            (it->second)(lineStream, os); //execute the command
+            raiseError(os) << "Command " << x << " unknown" << std::endl;
         }
 
         os << '\n';
     }
 }
 
+inline void Virtuoso::QuakeStyleConsole::tokenizeLine(std::string_view line, LineScratch &scratch, std::ostream &os)
+{
+    scratch.spans.clear();
+    scratch.tokens.clear();
+
+    bool expanding = false; // once we hit a $, the line is copied into scratch.expanded and spans index that instead
+    std::size_t i = 0;
+
+    while (i < line.size())
+    {
+        if (isConsoleSpace(line[i]))
+        {
+            if (expanding)
+            {
+                scratch.expanded.push_back(line[i]);
+            }
+            i++;
+            continue;
+        }
+
+        if (line[i] == '#') // comment runs to the end of the line
+        {
+            break;
+        }
+
+        const std::size_t tokenStart = i;
+
+        if (line[i] == '"') // a quoted token runs to the closing quote, whitespace and all
+        {
+            const std::size_t close = line.find('"', i + 1);
+            i = (close == line.npos) ? line.size() : close + 1;
+        }
+        else
+        {
+            while (i < line.size() && !isConsoleSpace(line[i]))
+            {
+                i++;
+            }
+        }
+
+        const std::string_view token = line.substr(tokenStart, i - tokenStart);
+
+        if (token[0] == '$')
+        {
+            if (!expanding)
+            {
+                scratch.expanded.assign(line.data(), tokenStart);
+                expanding = true;
+            }
+
+            if (expandVariable(token.substr(1), scratch, os))
+            {
+                continue;
+            }
+        }
+
+        // plain token, or a failed dereference which is left as written
+        if (expanding)
+        {
+            scratch.spans.push_back({scratch.expanded.size(), token.size()});
+            scratch.expanded.append(token);
+        }
+        else
+        {
+            scratch.spans.push_back({tokenStart, token.size()});
+        }
+    }
+
+    // trailing whitespace and comments aren't part of any argument
+    const std::size_t textEnd = scratch.spans.size() ? scratch.spans.back().begin + scratch.spans.back().length : 0;
+
+    scratch.text = (expanding ? std::string_view(scratch.expanded) : line).substr(0, textEnd);
+
+    for (const TokenSpan &span : scratch.spans)
+    {
+        scratch.tokens.push_back(scratch.text.substr(span.begin, span.length));
+    }
+}
+
+inline bool Virtuoso::QuakeStyleConsole::expandVariable(std::string_view identifier, LineScratch &scratch, std::ostream &os)
+{
+    if (identifier.empty())
+    {
+        raiseError(os) << "EXPECTED IDENTIFIER AT $" << std::endl;
+        return false;
+    }
+
+    const CVar *cvar = lookupCVar(identifier);
+
+    // check that variable exists
+    if (!cvar)
+    {
+        raiseError(os) << "Variable " << identifier << " not found" << std::endl;
+        return false;
+    }
+
+    const std::size_t valueStart = scratch.expanded.size();
+
+    scratch.expanded.append(cvarText(*cvar));
+
+    // the value may hold several tokens
+    std::size_t i = valueStart;
+
+    while (i < scratch.expanded.size())
+    {
+        if (isConsoleSpace(scratch.expanded[i]))
+        {
+            i++;
+            continue;
+        }
+
+        const std::size_t tokenStart = i;
+
+        while (i < scratch.expanded.size() && !isConsoleSpace(scratch.expanded[i]))
+        {
+            i++;
+        }
+
+        scratch.spans.push_back({tokenStart, i - tokenStart});
+    }
+
+    return true;
+}
+
 inline void Virtuoso::QuakeStyleConsole::bindBasicCommands()
 {
     std::function<void(const std::string &, const DynamicVariable &)> f1 =
@@ -798,27 +6514,80 @@ inline void Virtuoso::QuakeStyleConsole::bindBasicCommands()
             this, std::placeholders::_1, std::placeholders::_2);
 
     bindCommand("var", f1,
-                "Type var <varname> <value> to declare a dynamic variable with name <varname> and value <value>."
-                "\nVariable names are any space delimited string and variable value is set to the remainder of the line.");
+                HelpText::borrow("Type var <varname> <value> to declare a dynamic variable with name <varname> and value <value>."
+                "\nVariable names are any space delimited string and variable value is set to the remainder of the line."));
 
-    bindCommand("listCmd", [this](std::istream &is, std::ostream &os) { this->listCmd(os); }, "lists the available console commands");
+    bindCommand("listCmd", [this](ConsoleArgs &, std::ostream &os) { this->listCmd(os); }, HelpText::borrow("lists the available console commands"));
 
-    bindCommand("set", [this](std::istream &is, std::ostream &os) { this->commandSet(is, os); }, "type set <identifier> <val> to change the value of a cvar");
+    bindCommand("set", [this](ConsoleArgs &args, std::ostream &os) { this->commandSet(args, os); }, HelpText::borrow("type set <identifier> <val> to change the value of a cvar"));
+    setSymbol = symbols.find("set");
 
-    bindCommand("echo", [this](std::istream &is, std::ostream &os) { this->commandEcho(is, os); }, "type echo <identifier> to print the value of a cvar");
+    bindCommand("echo", [this](ConsoleArgs &args, std::ostream &os) { this->commandEcho(args, os); }, HelpText::borrow("type echo <identifier> to print the value of a cvar"));
 
-    bindCommand("listCVars", [this](std::istream &is, std::ostream &os) { listCVars(os); }, "lists the bound cvars");
+    bindCommand("listCVars", [this](ConsoleArgs &, std::ostream &os) { listCVars(os); }, HelpText::borrow("lists the bound cvars"));
 
-    bindCommand("help", [this](std::istream &is, std::ostream &os) { this->commandHelp(is, os); }, "you're a smartass");
+    bindCommand("help", [this](ConsoleArgs &args, std::ostream &os) { this->commandHelp(args, os); }, HelpText::borrow("you're a smartass"));
 
-    bindCommand("listHelp", [this](std::istream &is, std::ostream &os) { this->listHelp(os); }, "lists the available help topics");
+    bindCommand("listHelp", [this](ConsoleArgs &, std::ostream &os) { this->listHelp(os); }, HelpText::borrow("lists the available help topics"));
 
-    bindCommand("runFile", [this](std::istream &is, std::ostream &os) {
+    bindCommand("runFile", [this](ConsoleArgs &args, std::ostream &os) {
         std::string f;
-        is >> f;
-        this->executeFile(f, os);
+        ConsoleArgParser<std::string>::parse(args, f);
+        this->executeScript(f, os);
+    },
+                HelpText::borrow("runs the commands in a text file named by the argument.  Scripts are compiled once and cached until the file changes"));
+
+    bindCommand("wait", [this](ConsoleArgs &args, std::ostream &os) {
+        unsigned frames = 1;
+        if (!args.empty() && !ConsoleArgParser<unsigned>::parse(args, frames))
+        {
+            raiseError(os) << "wait takes a number of frames" << std::endl;
+            return;
+        }
+        requestWait(frames, std::chrono::steady_clock::duration::zero());
+    },
+                HelpText::borrow("in a script, type wait <frames> to run the rest of the script that many frames later.  Defaults to 1 frame"));
+
+    bindCommand("sleep", [this](ConsoleArgs &args, std::ostream &os) {
+        unsigned ms = 0;
+        if (!ConsoleArgParser<unsigned>::parse(args, ms))
+        {
+            raiseError(os) << "sleep takes a number of milliseconds" << std::endl;
+            return;
+        }
+        requestWait(0, std::chrono::milliseconds(ms));
     },
-                "runs the commands in a text file named by the argument");
+                HelpText::borrow("in a script, type sleep <ms> to run the rest of the script after that many milliseconds"));
+
+    bindCommand("jobs", [this](ConsoleArgs &args, std::ostream &os) { this->commandJobs(args, os); }, HelpText::borrow("lists the commands running in the background.  Type jobs cancel <id> to stop one"));
+
+    bindCommand("alias", [this](ConsoleArgs &args, std::ostream &os) { this->commandAlias(args, os); },
+                HelpText::borrow("type alias <name> \"<command>; <command>\" to make name run those commands.  alias <name> prints one, and alias alone lists them all"));
+
+    bindCommand("unalias", [this](ConsoleArgs &args, std::ostream &os) { this->commandUnalias(args, os); }, HelpText::borrow("type unalias <name> to remove an alias"));
+
+    setCompletion("set", cvarNameCompletion());
+    setCompletion("echo", cvarNameCompletion());
+    setCompletion("help", helpTopicCompletion());
+    setCompletion("runFile", filePathCompletion());
+
+    setCompletion("unalias", [this](std::string_view word, std::size_t argument, CompletionResult &result) {
+        if (argument != 1)
+        {
+            return;
+        }
+
+        completeIds.clear();
+        completeName(word, completeIds, SYMBOL_COMMAND);
+
+        for (SymbolID id : completeIds)
+        {
+            if (aliases.count(id))
+            {
+                result.candidates.emplace_back(symbols[id].name);
+            }
+        }
+    });
 }
 
 inline bool Virtuoso::QuakeStyleConsole::loadHistoryBuffer(const std::string &inFile)
@@ -873,87 +6642,143 @@ inline const std::deque<std::string> &Virtuoso::QuakeStyleConsole::historyBuffer
     return history_buffer;
 }
 
-inline void Virtuoso::QuakeStyleConsole::dereferenceVariables(std::istream &is, std::ostream &os, std::string &str)
+inline Virtuoso::QuakeStyleConsole::QuakeStyleConsole(size_t maxCapacity, size_t queueCapacity)
+    : history_buffer(maxCapacity),
+      queue(queueCapacity)
 {
-    size_t varBase = 0;
-    int n = 0;
-
-    while ((varBase = str.find('$', varBase)) != str.npos)
-    {
-        size_t substrEnd = varBase;
-        size_t dollar = varBase;
-        varBase++;
+    bindBasicCommands();
+}
 
-        n++;
+inline Virtuoso::QuakeStyleConsole::~QuakeStyleConsole()
+{
+    clearWaiting();
 
-        for (; ((substrEnd < str.size()) && (!isspace(str[substrEnd]))); substrEnd++)
-            ;
+    // unlisted jobs are only known to the workers, so cancel from their side : queued ones never start, running ones are asked to stop
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        stopJobs = true;
 
-        if (substrEnd == varBase)
+        for (const std::shared_ptr<ConsoleJob> &job : jobQueue)
         {
-            os << error() << "EXPECTED IDENTIFIER AT $" << std::endl;
+            job->cancel();
         }
-        else
-        {
-            std::string substr(str.substr(varBase, substrEnd - varBase));
-
-            std::stringstream sstr;
 
-            CVarPrintTable::iterator it = cvarPrintFTable.find(substr);
-
-            // check that variable exists
-            if (it != cvarPrintFTable.end())
-            {
-                it->second(is, sstr);
-                str.replace(dollar, substrEnd, sstr.str());
-            }
-            else
-            {
-                os << error() << "Variable " << substr << " not found" << std::endl;
-            }
+        for (const std::shared_ptr<ConsoleJob> &job : runningJobs)
+        {
+            job->cancel();
         }
     }
-}
 
-inline Virtuoso::QuakeStyleConsole::QuakeStyleConsole(size_t maxCapacity)
-    : history_buffer(maxCapacity)
-{
-    bindBasicCommands();
+    jobReady.notify_all();
+
+    for (std::thread &t : jobThreads)
+    {
+        t.join();
+    }
 }
 
 template <typename O, typename... Args>
-void Virtuoso::QuakeStyleConsole::bindMemberCommand(const std::string &commandName, O &obj, void (O::*fptr)(Args...), const std::string &help)
+void Virtuoso::QuakeStyleConsole::bindMemberCommand(const std::string &commandName, O &obj, void (O::*fptr)(Args...), HelpText help)
 {
-    auto mf = std::mem_fn(fptr);
-
-    std::function<void(const Args...)> fp =
-        [mf, &obj](const Args &... args) {
-            mf(obj, args...);
+    // capture the object and member pointer directly, rather than through a std::function that would be called through on every invocation
+    commandSlot(commandName) =
+        [this, &obj, fptr](ConsoleArgs &args, std::ostream &os) {
+            this->parse<Args...>(args, os, [&obj, fptr](const Args &... a) { (obj.*fptr)(a...); });
         };
 
-    bindCommand(commandName, fp);
-
-    if (help.length())
+    if (!help.empty())
     {
-        setHelpTopic(commandName, help);
+        setHelpTopic(commandName, std::move(help));
     }
 }
 
+namespace Virtuoso
+{
 /// here we just overload the iostream operators.  The only real difference is that on input a dynamic variable takes a full line from input
-inline std::ostream &operator<<(std::ostream &instream, const Virtuoso::QuakeStyleConsole::DynamicVariable &var)
+/// These live in the Virtuoso namespace so argument dependent lookup finds them ahead of the std::string operators
+inline std::ostream &operator<<(std::ostream &instream, const QuakeStyleConsole::DynamicVariable &var)
 {
     const std::string &str = var;
     return instream << str;
 }
 
 /// dynamic variable definitions take a full line from the input stream
-inline std::istream &operator>>(std::istream &istream, Virtuoso::QuakeStyleConsole::DynamicVariable &var)
+inline std::istream &operator>>(std::istream &istream, QuakeStyleConsole::DynamicVariable &var)
 {
     return getline(istream, var);
 }
 
+inline bool ConsoleArgParser<QuakeStyleConsole::DynamicVariable>::parse(ConsoleArgs &args, QuakeStyleConsole::DynamicVariable &value)
+{
+    if (args.empty())
+    {
+        return false;
+    }
+
+    const std::string_view text = (args.remaining() == 1) ? unquoteToken(args.rest()) : args.rest();
+
+    value.assign(text.data(), text.size());
+    args.skipAll();
+    return true;
+}
+} // namespace Virtuoso
+
 #endif /* QuakeStyleConsole_h */
 
+// -----------------------------------------------------------------------------
+// AllocationProbe implementation.  Replaces the global operator new / delete so allocations are counted.
+// -----------------------------------------------------------------------------
+#if defined(VIRTUOSO_CONSOLE_ALLOCATION_PROBE_IMPLEMENTATION) && !defined(NDEBUG) && !defined(VIRTUOSO_CONSOLE_ALLOCATION_PROBE_IMPLEMENTED)
+#define VIRTUOSO_CONSOLE_ALLOCATION_PROBE_IMPLEMENTED
+
+#include <new>
+#include <cstdlib>
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete" // these ARE the matching new / delete; gcc sees malloc / free once they're inlined
+#endif
+
+static const bool virtuosoAllocationProbeInstalled = (Virtuoso::AllocationProbe::installed = true);
+
+void *operator new(std::size_t bytes)
+{
+    Virtuoso::AllocationProbe::record(bytes);
+
+    if (void *p = std::malloc(bytes ? bytes : 1))
+    {
+        return p;
+    }
+
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t bytes)
+{
+    return ::operator new(bytes);
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+#endif
+
 /* ------------------------------------------------------------------------------
 ALTERNATIVE A - MIT License
 Copyright (c) 2020 Virtuoso Engine
@@ -0,0 +1,1310 @@
+#define VIRTUOSO_CONSOLE_ALLOCATION_PROBE_IMPLEMENTATION
+#include "../QuakeStyleConsole.h"
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace Virtuoso;
+
+/// VirtuosoConsole benchmark program.
+/// Checks that steady state command execution doesn't allocate, and times the hot paths.
+/// Build without NDEBUG to enable the allocation checks.
+
+/// ostream target that throws away everything written to it
+class NullBuf : public std::streambuf
+{
+  protected:
+    int overflow(int c) { return c; }
+    std::streamsize xsputn(const char *, std::streamsize n) { return n; }
+};
+
+int health = 100;
+float gravity = 9.8f;
+int total = 0;
+
+void addToTotal(int a, int b)
+{
+    total += a + b;
+}
+
+/// a float that can only be parsed with operator >>, for comparing against the ConsoleArgParser fast path
+struct StreamFloat
+{
+    float value = 0.0f;
+};
+
+std::istream &operator>>(std::istream &is, StreamFloat &f) { return is >> f.value; }
+std::ostream &operator<<(std::ostream &os, const StreamFloat &f) { return os << f.value; }
+
+/// a custom cvar type that prints its text as it is and reads back the rest of the line
+struct Label
+{
+    std::string text;
+};
+
+std::istream &operator>>(std::istream &is, Label &l) { return std::getline(is, l.text); }
+std::ostream &operator<<(std::ostream &os, const Label &l) { return os << l.text; }
+
+class Counter
+{
+  public:
+    int count = 0;
+
+    void add(int a)
+    {
+        count += a;
+    }
+};
+
+/// runs the line enough times to warm up the console's scratch buffers, then checks that further runs don't allocate
+bool checkNoAllocations(QuakeStyleConsole &console, const char *line, unsigned flags)
+{
+    NullBuf nb;
+    std::ostream out(&nb);
+
+    for (int i = 0; i < 16; i++)
+    {
+        console.commandExecute(line, out, flags);
+    }
+
+    const int iterations = 1000;
+
+    AllocationScope scope;
+
+    for (int i = 0; i < iterations; i++)
+    {
+        console.commandExecute(line, out, flags);
+    }
+
+    const bool pass = (scope.count() == 0);
+
+    std::clog << (pass ? "[pass] " : "[FAIL] ") << '"' << line << "\" : "
+              << double(scope.count()) / iterations << " allocations per command" << std::endl;
+
+    return pass;
+}
+
+bool allocationTests(QuakeStyleConsole &console)
+{
+    if (!AllocationProbe::installed)
+    {
+        std::clog << "Allocation probe not installed (NDEBUG build); skipping allocation checks" << std::endl;
+        return true;
+    }
+
+    std::clog << "\n-- Allocations per command in steady state --" << std::endl;
+
+    bool pass = true;
+
+    pass &= checkNoAllocations(console, "set health 25", QuakeStyleConsole::EXECUTE_SILENT);
+    pass &= checkNoAllocations(console, "echo health", QuakeStyleConsole::EXECUTE_SILENT);
+    pass &= checkNoAllocations(console, "echo health", QuakeStyleConsole::EXECUTE_ECHO);
+    pass &= checkNoAllocations(console, "set gravity 1.5", QuakeStyleConsole::EXECUTE_SILENT);
+    pass &= checkNoAllocations(console, "set health $count", QuakeStyleConsole::EXECUTE_SILENT);
+    pass &= checkNoAllocations(console, "add 1 2", QuakeStyleConsole::EXECUTE_SILENT);
+    pass &= checkNoAllocations(console, "counterAdd 3", QuakeStyleConsole::EXECUTE_SILENT);
+    pass &= checkNoAllocations(console, "set health 1 echo health # two commands", QuakeStyleConsole::EXECUTE_SILENT);
+    pass &= checkNoAllocations(console, "burst", QuakeStyleConsole::EXECUTE_SILENT);
+
+    return pass;
+}
+
+/// average time per line of executing line n times
+double timeCommand(QuakeStyleConsole &console, const char *line, int n)
+{
+    NullBuf nb;
+    std::ostream out(&nb);
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    for (int i = 0; i < n; i++)
+    {
+        console.commandExecute(line, out, QuakeStyleConsole::EXECUTE_SILENT);
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / n;
+}
+
+void timings(QuakeStyleConsole &console)
+{
+    std::clog << "\n-- Time per command --" << std::endl;
+
+    // burst is an alias for the line after it
+    const char *lines[] = {"set health 25", "echo health", "set gravity 1.5", "set health $count", "add 1 2", "counterAdd 3",
+                           "burst", "counterAdd 1 add 1 2 set health 5"};
+
+    for (const char *line : lines)
+    {
+        std::clog << '"' << line << "\" : " << timeCommand(console, line, 200000) << " ns" << std::endl;
+    }
+}
+
+template <class F>
+double nanosecondsPer(int n, F &&f)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+
+    f();
+
+    auto end = std::chrono::high_resolution_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / n;
+}
+
+/// ConsoleArgParser against the iostream parsing it replaced, first on raw tokens and then for a config file worth of set commands
+void parserBenchmark()
+{
+    std::clog << "\n-- ConsoleArgParser vs iostream --" << std::endl;
+
+    const int n = 200000;
+
+    std::vector<std::string> text;
+    for (int i = 0; i < n; i++)
+    {
+        text.push_back((i & 1) ? std::to_string(i) : std::to_string(i * 0.25f));
+    }
+
+    std::vector<std::string_view> tokens(text.begin(), text.end());
+
+    float sum = 0.0f;
+
+    double fast = nanosecondsPer(n, [&]() {
+        for (std::string_view &tok : tokens)
+        {
+            ConsoleArgs args(tok, &tok, 1);
+            float f = 0.0f;
+            ConsoleArgParser<float>::parse(args, f);
+            sum += f;
+        }
+    });
+
+    double view = nanosecondsPer(n, [&]() {
+        for (std::string_view &tok : tokens)
+        {
+            ViewIStream is(tok);
+            float f = 0.0f;
+            is >> f;
+            sum += f;
+        }
+    });
+
+    double sstream = nanosecondsPer(n, [&]() {
+        for (std::string_view &tok : tokens)
+        {
+            std::stringstream is;
+            is.str(std::string(tok));
+            float f = 0.0f;
+            is >> f;
+            sum += f;
+        }
+    });
+
+    std::clog << "ConsoleArgParser<float> : " << fast << " ns per value" << std::endl;
+    std::clog << "operator >> on a ViewIStream : " << view << " ns per value (" << view / fast << "x)" << std::endl;
+    std::clog << "operator >> on a stringstream : " << sstream << " ns per value (" << sstream / fast << "x)" << std::endl;
+
+    // config load : thousands of numeric cvars set from a script
+    const int cvarCount = 5000;
+
+    std::vector<float> fastVars(cvarCount);
+    std::vector<StreamFloat> streamVars(cvarCount);
+
+    QuakeStyleConsole console;
+    std::string fastScript;
+    std::string streamScript;
+
+    for (int i = 0; i < cvarCount; i++)
+    {
+        console.bindCVar("fast" + std::to_string(i), fastVars[i]);
+        console.bindCVar("stream" + std::to_string(i), streamVars[i]);
+
+        fastScript += "set fast" + std::to_string(i) + " " + std::to_string(i * 0.5f) + "\n";
+        streamScript += "set stream" + std::to_string(i) + " " + std::to_string(i * 0.5f) + "\n";
+    }
+
+    NullBuf nb;
+    std::ostream out(&nb);
+
+    double fastLoad = nanosecondsPer(cvarCount, [&]() { console.commandExecute(fastScript, out, QuakeStyleConsole::EXECUTE_SILENT); });
+    double streamLoad = nanosecondsPer(cvarCount, [&]() { console.commandExecute(streamScript, out, QuakeStyleConsole::EXECUTE_SILENT); });
+
+    std::clog << "config load, ConsoleArgParser : " << fastLoad << " ns per line" << std::endl;
+    std::clog << "config load, operator >> : " << streamLoad << " ns per line (" << streamLoad / fastLoad << "x)" << std::endl;
+
+    if (sum == 42.0f) // keep the optimizer honest
+        std::clog << std::endl;
+}
+
+/// per command dispatch cost: a direct call, a call through the console's command table, and the same call through a std::function
+bool dispatchBenchmark(QuakeStyleConsole &console)
+{
+    std::clog << "\n-- Command dispatch vs direct call --" << std::endl;
+
+    const int n = 2000000;
+
+    NullBuf nb;
+    std::ostream out(&nb);
+
+    std::string_view tokens[] = {"1", "2"};
+    const std::string_view text = "1 2";
+
+    void (*volatile direct)(int, int) = addToTotal; // volatile so the call can't be inlined away
+
+    double directCall = nanosecondsPer(n, [&]() {
+        for (int i = 0; i < n; i++)
+        {
+            ConsoleArgs args(text, tokens, 2);
+            int a = 0, b = 0;
+            ConsoleArgParser<int>::parse(args, a);
+            ConsoleArgParser<int>::parse(args, b);
+            direct(a, b);
+        }
+    });
+
+    const QuakeStyleConsole::CommandFunc &command = console.getSymbol(console.findSymbol("add")).command;
+
+    double table = nanosecondsPer(n, [&]() {
+        for (int i = 0; i < n; i++)
+        {
+            ConsoleArgs args(text, tokens, 2);
+            command(args, out);
+        }
+    });
+
+    std::function<void(ConsoleArgs &, std::ostream &)> wrapped = [&command](ConsoleArgs &args, std::ostream &os) { command(args, os); };
+
+    double function = nanosecondsPer(n, [&]() {
+        for (int i = 0; i < n; i++)
+        {
+            ConsoleArgs args(text, tokens, 2);
+            wrapped(args, out);
+        }
+    });
+
+    double line = timeCommand(console, "add 1 2", n / 10);
+
+    std::clog << "parse and direct call : " << directCall << " ns" << std::endl;
+    std::clog << "command table (InplaceFunction) : " << table << " ns (+" << table - directCall << " ns dispatch)" << std::endl;
+    std::clog << "command table through std::function : " << function << " ns (+" << function - directCall << " ns dispatch)" << std::endl;
+    std::clog << "commandExecute(\"add 1 2\") : " << line << " ns (+" << line - directCall << " ns tokenize, lookup and dispatch)" << std::endl;
+
+    // a callable too big for the buffer, like a lambda holding a std::function on MSVC, goes to the heap and still works when copied and moved
+    std::array<int, 32> weights;
+    weights.fill(1);
+    int weighed = 0;
+
+    auto large = [weights, &weighed](ConsoleArgs &, std::ostream &) {
+        for (int w : weights)
+            weighed += w;
+    };
+
+    QuakeStyleConsole::CommandFunc original(large);
+    QuakeStyleConsole::CommandFunc copied(original);
+    QuakeStyleConsole::CommandFunc moved(std::move(original));
+    original = copied;
+
+    ConsoleArgs none;
+    copied(none, out);
+    moved(none, out);
+    original(none, out);
+
+    console.bindCommand("weigh", large);
+    console.bindCommand("weighFunction", std::function<void(int)>([weights, &weighed](int times) { weighed += times * int(weights.size()); }));
+    console.commandExecute("weigh", out);
+    console.commandExecute("weighFunction 2", out);
+
+    const bool pass = !QuakeStyleConsole::CommandFunc::storedInplace<decltype(large)>() && weighed == 6 * 32;
+    std::clog << (pass ? "[pass] " : "[FAIL] ") << "a " << sizeof(large) << " byte command is kept on the heap and runs from copies, moves and the table" << std::endl;
+
+    return pass;
+}
+
+/// polling a few hundred cvars per frame, as a watch window would: formatted through echo, read with getCVar, and read through a cached pointer
+bool cvarPollBenchmark()
+{
+    std::clog << "\n-- Polling cvars --" << std::endl;
+
+    const int cvarCount = 500;
+    const int frames = 200;
+
+    std::vector<float> values(cvarCount);
+    std::vector<std::string> names;
+
+    QuakeStyleConsole console;
+
+    for (int i = 0; i < cvarCount; i++)
+    {
+        names.push_back("r_value" + std::to_string(i));
+        console.bindCVar(names.back(), values[i]);
+    }
+
+    std::vector<std::string> echoLines;
+    for (const std::string &name : names)
+    {
+        echoLines.push_back("echo " + name);
+    }
+
+    std::string text;
+    StringAppendBuf buf(text);
+    std::ostream out(&buf);
+
+    float sum = 0.0f;
+
+    double echo = nanosecondsPer(cvarCount * frames, [&]() {
+        for (int f = 0; f < frames; f++)
+        {
+            for (const std::string &line : echoLines)
+            {
+                text.clear();
+                console.commandExecute(line, out, QuakeStyleConsole::EXECUTE_SILENT);
+                sum += text.size();
+            }
+        }
+    });
+
+    double typed = nanosecondsPer(cvarCount * frames, [&]() {
+        for (int f = 0; f < frames; f++)
+        {
+            for (const std::string &name : names)
+            {
+                sum += console.getCVar<float>(name).value_or(0.0f);
+            }
+        }
+    });
+
+    std::vector<const float *> cached;
+    for (const std::string &name : names)
+    {
+        cached.push_back(console.findCVar<float>(name));
+    }
+
+    double pointer = nanosecondsPer(cvarCount * frames, [&]() {
+        for (int f = 0; f < frames; f++)
+        {
+            for (const float *value : cached)
+            {
+                sum += *(volatile const float *)value;
+            }
+        }
+    });
+
+    // a renderer that compares every cvar against its last frame's value, against one watching r_ and hearing about the few that were set
+    std::vector<float> lastSeen(values);
+    int rebuilds = 0;
+
+    double compare = nanosecondsPer(frames, [&]() {
+        for (int f = 0; f < frames; f++)
+        {
+            console.setCVar(names[f % cvarCount], float(f));
+
+            for (int i = 0; i < cvarCount; i++)
+            {
+                const float v = *(volatile const float *)cached[i];
+                if (v != lastSeen[i])
+                {
+                    lastSeen[i] = v;
+                    rebuilds++;
+                }
+            }
+        }
+    });
+
+    const int compared = rebuilds;
+    rebuilds = 0;
+
+    console.watchCVarPrefix("r_", [&rebuilds](std::string_view, const QuakeStyleConsole::CVar &) { rebuilds++; });
+
+    double watched = nanosecondsPer(frames, [&]() {
+        for (int f = 0; f < frames; f++)
+        {
+            console.setCVar(names[f % cvarCount], float(f + 1));
+            console.setCVar(names[f % cvarCount], float(f + 2)); // coalesced with the first
+            console.dispatchChanges();
+        }
+    });
+
+    std::clog << "echo to text : " << echo << " ns per cvar" << std::endl;
+    std::clog << "getCVar<float> : " << typed << " ns per cvar (" << echo / typed << "x faster)" << std::endl;
+    std::clog << "cached findCVar<float> pointer : " << pointer << " ns per cvar" << std::endl;
+    std::clog << "comparing " << cvarCount << " cvars each frame : " << compare << " ns per frame" << std::endl;
+    std::clog << "prefix watcher and dispatchChanges : " << watched << " ns per frame" << std::endl;
+
+    const bool pass = (rebuilds == frames) && (compared > 0);
+    std::clog << (pass ? "[pass] " : "[FAIL] ") << "one coalesced notification per frame for two sets" << std::endl;
+
+    if (sum == 42.0f) // keep the optimizer honest
+        std::clog << std::endl;
+
+    return pass;
+}
+
+/// an admin script with lineCount lines, one in a thousand of them an error
+std::string makeScript(int lineCount)
+{
+    std::string script;
+    for (int i = 0; i < lineCount; i++)
+    {
+        switch (i % 4)
+        {
+        case 0: script += "set health " + std::to_string(i % 100) + "\n"; break;
+        case 1: script += "add 1 2 # comment\n"; break;
+        case 2: script += "set gravity 9.8\n"; break;
+        case 3: script += (i % 1000 == 3) ? "nosuchcommand\n" : "counterAdd 1\n"; break;
+        }
+    }
+    return script;
+}
+
+/// replaying a long admin script : line at a time through executeUntilEOF, against executeBatch
+bool batchBenchmark(QuakeStyleConsole &console)
+{
+    std::clog << "\n-- 200k line script --" << std::endl;
+
+    const int lineCount = 200000;
+
+    const std::string script = makeScript(lineCount);
+
+    NullBuf nb;
+    std::ostream out(&nb);
+
+    double lineAtATime = nanosecondsPer(lineCount, [&]() {
+        std::istringstream is(script);
+        console.executeUntilEOF(is, out);
+    });
+
+    QuakeStyleConsole::BatchResult echoed;
+    double batchDefault = nanosecondsPer(lineCount, [&]() { echoed = console.executeBatch(script, out, QuakeStyleConsole::EXECUTE_DEFAULT); });
+
+    QuakeStyleConsole::BatchResult silent;
+    double batchSilent = nanosecondsPer(lineCount, [&]() { silent = console.executeBatch(script, out, QuakeStyleConsole::EXECUTE_SILENT); });
+
+    std::clog << "executeUntilEOF : " << lineAtATime * lineCount / 1e6 << " ms" << std::endl;
+    std::clog << "executeBatch, echo and history : " << batchDefault * lineCount / 1e6 << " ms (" << lineAtATime / batchDefault << "x)" << std::endl;
+    std::clog << "executeBatch, silent : " << batchSilent * lineCount / 1e6 << " ms (" << lineAtATime / batchSilent << "x)" << std::endl;
+
+    const std::size_t expectedErrors = lineCount / 1000;
+    const bool pass = silent.lines == std::size_t(lineCount) && silent.errors == expectedErrors && silent.firstErrorLine == 3 && echoed.errors == expectedErrors;
+
+    std::clog << (pass ? "[pass] " : "[FAIL] ") << silent.lines << " lines, " << silent.errors << " errors, first error on line " << silent.firstErrorLine << std::endl;
+
+    QuakeStyleConsole::BatchResult stopped = console.executeBatch(script, out, QuakeStyleConsole::EXECUTE_STOP_ON_ERROR);
+    const bool stopPass = stopped.stopped && stopped.lines == 4 && stopped.errors == 1;
+
+    std::clog << (stopPass ? "[pass] " : "[FAIL] ") << "EXECUTE_STOP_ON_ERROR stopped after " << stopped.lines << " lines" << std::endl;
+
+    return pass && stopPass;
+}
+
+/// running a script file : memory mapped executeFile, against streaming it and reading it a line at a time
+bool fileBenchmark(QuakeStyleConsole &console)
+{
+    std::clog << "\n-- 200k line script file --" << std::endl;
+
+    const int lineCount = 200000;
+    const char *path = "consoleBenchScript.txt";
+
+    {
+        std::ofstream f(path, std::ios::binary);
+        f << makeScript(lineCount);
+    }
+
+    NullBuf nb;
+    std::ostream out(&nb);
+
+    console.executeFile(path, out, QuakeStyleConsole::EXECUTE_SILENT); // warm up
+
+    QuakeStyleConsole::BatchResult mappedResult;
+    std::size_t mappedAllocations = 0;
+
+    double mapped = nanosecondsPer(lineCount, [&]() {
+        AllocationScope scope;
+        mappedResult = console.executeFile(path, out, QuakeStyleConsole::EXECUTE_SILENT);
+        mappedAllocations = scope.count();
+    });
+
+    double streamed = nanosecondsPer(lineCount, [&]() {
+        std::ifstream f(path, std::ios::binary);
+        console.executeBatch(f, out, QuakeStyleConsole::EXECUTE_SILENT);
+    });
+
+    double lineAtATime = nanosecondsPer(lineCount, [&]() {
+        std::ifstream f(path);
+        while (!f.eof())
+        {
+            console.commandExecute(f, out, QuakeStyleConsole::EXECUTE_SILENT);
+        }
+    });
+
+    std::remove(path);
+
+    std::clog << "getline and commandExecute : " << lineAtATime * lineCount / 1e6 << " ms" << std::endl;
+    std::clog << "executeBatch on an ifstream : " << streamed * lineCount / 1e6 << " ms (" << lineAtATime / streamed << "x)" << std::endl;
+    std::clog << "executeFile, memory mapped : " << mapped * lineCount / 1e6 << " ms (" << lineAtATime / mapped << "x)" << std::endl;
+
+    if (!AllocationProbe::installed)
+    {
+        return mappedResult.lines == std::size_t(lineCount);
+    }
+
+    // the errors in the script allocate for their messages, so allow a few per error line but nothing per line
+    const bool pass = mappedResult.lines == std::size_t(lineCount) && mappedAllocations <= 4 * mappedResult.errors;
+
+    std::clog << (pass ? "[pass] " : "[FAIL] ") << mappedAllocations << " allocations for " << mappedResult.lines << " lines with "
+              << mappedResult.errors << " errors" << std::endl;
+
+    return pass;
+}
+
+/// re-running the same 20k line setup script on every level load : executeFile against the compiled script cache
+bool scriptCacheBenchmark(QuakeStyleConsole &console)
+{
+    std::clog << "\n-- 20k line level setup script, run 20 times --" << std::endl;
+
+    const int lineCount = 20000;
+    const int runs = 20;
+    const char *path = "consoleBenchLevel.txt";
+
+    {
+        std::ofstream f(path, std::ios::binary);
+        f << makeScript(lineCount);
+    }
+
+    NullBuf nb;
+    std::ostream out(&nb);
+
+    double uncached = nanosecondsPer(lineCount * runs, [&]() {
+        for (int i = 0; i < runs; i++)
+        {
+            console.executeFile(path, out, QuakeStyleConsole::EXECUTE_SILENT);
+        }
+    });
+
+    QuakeStyleConsole::BatchResult result;
+
+    double cached = nanosecondsPer(lineCount * runs, [&]() {
+        for (int i = 0; i < runs; i++)
+        {
+            result = console.executeScript(path, out, QuakeStyleConsole::EXECUTE_SILENT);
+        }
+    });
+
+    std::clog << "executeFile : " << uncached * lineCount / 1e6 << " ms per run" << std::endl;
+    std::clog << "executeScript, compiled : " << cached * lineCount / 1e6 << " ms per run (" << uncached / cached << "x)" << std::endl;
+
+    bool pass = result.lines == std::size_t(lineCount) && result.errors == std::size_t(lineCount / 1000);
+
+    // editing the file has to show up on the next run
+    {
+        std::ofstream f(path, std::ios::binary);
+        f << "set health 77\n";
+    }
+
+    console.executeScript(path, out, QuakeStyleConsole::EXECUTE_SILENT);
+    pass &= (health == 77);
+
+    // so does binding a command the script uses
+    {
+        std::ofstream f(path, std::ios::binary);
+        f << "later 5\n";
+    }
+
+    console.executeScript(path, out, QuakeStyleConsole::EXECUTE_SILENT);
+
+    int later = 0;
+    console.bindCommand("later", std::function<void(int)>([&later](int x) { later = x; }));
+    console.executeScript(path, out, QuakeStyleConsole::EXECUTE_SILENT);
+    pass &= (later == 5);
+
+    std::remove(path);
+
+    std::clog << (pass ? "[pass] " : "[FAIL] ") << "results match, and edits and new bindings are picked up" << std::endl;
+
+    return pass;
+}
+
+/// a long script spread over frames : how long the worst frame takes with a line cap, and with a time budget
+bool steppedScriptBenchmark(QuakeStyleConsole &console)
+{
+    std::clog << "\n-- 200k line script, stepped over frames --" << std::endl;
+
+    const int lineCount = 200000;
+    const std::string script = makeScript(lineCount);
+
+    NullBuf nb;
+    std::ostream out(&nb);
+
+    auto runFrames = [&](auto &&stepFrame, double &worstMs) {
+        QuakeStyleConsole::ScriptExecutor executor = console.startScriptText(script, QuakeStyleConsole::EXECUTE_SILENT);
+
+        int frames = 0;
+        worstMs = 0.0;
+
+        bool more = true;
+        while (more)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            more = stepFrame(executor);
+            worstMs = std::max(worstMs, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            frames++;
+        }
+
+        std::clog << frames << " frames, worst frame " << worstMs << " ms, " << executor.result().seconds * 1000.0 << " ms in total" << std::endl;
+
+        return executor.result().lines == std::size_t(lineCount) && executor.result().errors == std::size_t(lineCount / 1000);
+    };
+
+    double worstCapped = 0.0;
+    double worstBudget = 0.0;
+
+    std::clog << "1000 lines per frame : ";
+    bool pass = runFrames([&](QuakeStyleConsole::ScriptExecutor &e) { return e.step(out, 1000); }, worstCapped);
+
+    std::clog << "1 ms per frame : ";
+    pass &= runFrames([&](QuakeStyleConsole::ScriptExecutor &e) { return e.step(out, std::chrono::microseconds(1000)); }, worstBudget);
+
+    // cancelling leaves the rest of the script unrun
+    QuakeStyleConsole::ScriptExecutor cancelled = console.startScriptText(script, QuakeStyleConsole::EXECUTE_SILENT);
+    cancelled.step(out, 100);
+    cancelled.cancel();
+    pass &= !cancelled.step(out, 100) && cancelled.done() && cancelled.linesRun() == 100 && cancelled.progress() < 0.01f;
+
+    std::clog << (pass ? "[pass] " : "[FAIL] ") << "every line ran once across the frames, and cancel stops the script" << std::endl;
+
+    // a wait in a script run by another one holds up the caller too, so the lines still run in order
+    std::string order;
+    QuakeStyleConsole waiter;
+    waiter.bindCommand("mark", std::function<void(std::string)>([&order](std::string s) { order += s; }));
+
+    std::ofstream("consoleBenchInner.txt") << "mark i1\nwait\nmark i2\n";
+    std::ofstream("consoleBenchLast.txt") << "mark l1\nwait 2\n";
+    std::ofstream("consoleBenchOuter.txt") << "mark o1\nrunFile consoleBenchInner.txt\nmark o2\nrunFile consoleBenchLast.txt\nmark o3\n";
+
+    waiter.executeScript("consoleBenchOuter.txt", out);
+
+    for (int frame = 0; frame < 4; frame++)
+    {
+        order += '|';
+        waiter.tick(out);
+    }
+
+    const bool ordered = order == "o1i1|i2o2l1||o3|";
+
+    std::remove("consoleBenchInner.txt");
+    std::remove("consoleBenchLast.txt");
+    std::remove("consoleBenchOuter.txt");
+
+    std::clog << (ordered ? "[pass] " : "[FAIL] ") << "a wait in a nested runFile holds up the script that ran it" << std::endl;
+
+    return pass && ordered;
+}
+
+/// autosaving a big config : the first save, a save after a few changes, and a save with nothing changed
+bool configBenchmark()
+{
+    std::clog << "\n-- saveConfig with 20k archived cvars --" << std::endl;
+
+    const int cvarCount = 20000;
+    const char *path = "consoleBenchConfig.cfg";
+
+    std::vector<int> values(cvarCount);
+    QuakeStyleConsole console;
+
+    for (int i = 0; i < cvarCount; i++)
+    {
+        values[i] = i;
+        console.bindCVar("cfg_value" + std::to_string(i), values[i], "", QuakeStyleConsole::CVAR_ARCHIVE);
+    }
+
+    QuakeStyleConsole::SaveResult first, changed, unchanged;
+
+    double full = nanosecondsPer(1, [&]() { first = console.saveConfig(path); });
+
+    for (int i = 0; i < 10; i++)
+    {
+        values[i * 1000] = -i; // changed from C++, behind the console's back
+    }
+
+    double few = nanosecondsPer(1, [&]() { changed = console.saveConfig(path); });
+    double none = nanosecondsPer(1, [&]() { unchanged = console.saveConfig(path); });
+
+    std::fill(values.begin(), values.end(), 0);
+
+    NullBuf nb;
+    std::ostream out(&nb);
+    QuakeStyleConsole::BatchResult loaded;
+    double load = nanosecondsPer(1, [&]() { loaded = console.loadConfig(path, out); });
+
+    std::clog << "first save : " << full / 1e6 << " ms" << std::endl;
+    std::clog << "save after 10 changes : " << few / 1e6 << " ms" << std::endl;
+    std::clog << "save with no changes : " << none / 1e3 << " us" << std::endl;
+    std::clog << "loadConfig : " << load / 1e6 << " ms" << std::endl;
+
+    const bool pass = first == QuakeStyleConsole::SAVE_WRITTEN && changed == QuakeStyleConsole::SAVE_WRITTEN && unchanged == QuakeStyleConsole::SAVE_SKIPPED &&
+                      loaded.errors == 0 && values[5000] == -5 && values[4321] == 4321 && console.unsavedCVarCount() == 0;
+
+    std::remove(path);
+
+    std::clog << (pass ? "[pass] " : "[FAIL] ") << "changes from C++ are saved, an unchanged save is skipped, and the file loads back" << std::endl;
+
+    // strings that would split, start a comment, expand a variable or lose their outer spaces come back as they were.  One with a quote can't be written
+    // at all, nor can custom text that would expand a variable, so the file keeps their last values and they stay unsaved
+    const std::string tricky[] = {"two words", "", "#not a comment", "$health", "tab\there", "trailing ", "  leading"};
+    const int trickyCount = int(std::size(tricky));
+    std::string strings[std::size(tricky)];
+    std::string quoted = "plain";
+    QuakeStyleConsole writer;
+
+    for (int i = 0; i < trickyCount; i++)
+    {
+        strings[i] = tricky[i];
+        writer.bindCVar("cfg_string" + std::to_string(i), strings[i], "", QuakeStyleConsole::CVAR_ARCHIVE);
+    }
+
+    writer.bindCVar("cfg_quoted", quoted, "", QuakeStyleConsole::CVAR_ARCHIVE);
+
+    Label label{"plain label"};
+    writer.bindCVar("cfg_label", label, "", QuakeStyleConsole::CVAR_ARCHIVE);
+    writer.saveConfig(path);
+
+    quoted = "say \"hi\"";
+    writer.commandExecute("set cfg_label hello $nobody", out); // $nobody isn't a variable now, but could be when the file is loaded
+    const QuakeStyleConsole::SaveResult quotedSave = writer.saveConfig(path);
+    const QuakeStyleConsole::SaveResult quotedAgain = writer.saveConfig(path);
+    const std::size_t unsaved = writer.unsavedCVarCount();
+
+    for (std::string &s : strings)
+    {
+        s = "changed";
+    }
+
+    quoted = "changed";
+    label.text = "changed";
+    writer.loadConfig(path, out);
+
+    bool roundTrip = quotedSave == QuakeStyleConsole::SAVE_WRITTEN && quotedAgain == QuakeStyleConsole::SAVE_SKIPPED && unsaved == 2 && quoted == "plain" &&
+                     label.text == "plain label";
+
+    for (int i = 0; i < trickyCount; i++)
+    {
+        roundTrip &= strings[i] == tricky[i];
+    }
+
+    std::remove(path);
+
+    std::clog << (roundTrip ? "[pass] " : "[FAIL] ") << "awkward strings load back as saved, and a string with a quote or a label with a $ is left unsaved" << std::endl;
+
+    return pass && roundTrip;
+}
+
+/// restoring 20k cvars at startup : a binary snapshot against replaying the same values as a config
+bool snapshotBenchmark()
+{
+    std::clog << "\n-- restoring 20k cvars from a snapshot --" << std::endl;
+
+    const int cvarCount = 20000;
+    const char *snapshotPath = "consoleBenchSnapshot.bin";
+    const char *configPath = "consoleBenchSnapshot.cfg";
+
+    std::vector<int> values(cvarCount);
+    std::vector<float> scales(cvarCount);
+    QuakeStyleConsole console;
+
+    for (int i = 0; i < cvarCount / 2; i++)
+    {
+        values[i] = i;
+        scales[i] = i * 0.25f;
+        console.bindCVar("snap_value" + std::to_string(i), values[i], "", QuakeStyleConsole::CVAR_ARCHIVE);
+        console.bindCVar("snap_scale" + std::to_string(i), scales[i], "", QuakeStyleConsole::CVAR_ARCHIVE);
+    }
+
+    const bool saved = console.saveSnapshot(snapshotPath) && console.saveConfig(configPath, true) == QuakeStyleConsole::SAVE_WRITTEN;
+
+    NullBuf nb;
+    std::ostream out(&nb);
+
+    std::fill(values.begin(), values.end(), 0);
+    std::fill(scales.begin(), scales.end(), 0.0f);
+
+    QuakeStyleConsole::BatchResult config;
+    double text = nanosecondsPer(1, [&]() { config = console.executeFile(configPath, out, QuakeStyleConsole::EXECUTE_SILENT); });
+
+    std::fill(values.begin(), values.end(), 0);
+    std::fill(scales.begin(), scales.end(), 0.0f);
+
+    QuakeStyleConsole::SnapshotResult snapshot;
+    double binary = nanosecondsPer(1, [&]() { snapshot = console.loadSnapshot(snapshotPath, out); });
+
+    std::clog << "config through executeFile : " << text / 1e6 << " ms" << std::endl;
+    std::clog << "loadSnapshot : " << binary / 1e6 << " ms (" << snapshot.direct << " direct, " << snapshot.lookedUp << " looked up, " << snapshot.replayed << " replayed)" << std::endl;
+
+    const bool pass = saved && config.errors == 0 && snapshot.loaded && snapshot.replayed == 0 && values[7777] == 7777 && scales[9999] == 9999 * 0.25f;
+
+    std::remove(snapshotPath);
+    std::remove(configPath);
+
+    std::clog << (pass ? "[pass] " : "[FAIL] ") << "every value comes back from the snapshot without going through set" << std::endl;
+
+    // strings restored into vars go through set.  One with spaces comes back whole; one with a quote can't be, so it's skipped.
+    // Custom text goes through set as it was printed, quotes and all, unless it would split the line or start a comment
+    std::string words = "two words";
+    std::string quoted = "say \"hi\"";
+    Label labels[] = {{"red green"}, {"say \"hi there\""}, {"one\nset snap_words hacked"}, {"x # cut"}};
+    QuakeStyleConsole writer;
+    writer.bindCVar("snap_words", words);
+    writer.bindCVar("snap_quoted", quoted);
+
+    for (int i = 0; i < 4; i++)
+    {
+        writer.bindCVar("snap_label" + std::to_string(i), labels[i]);
+    }
+
+    writer.saveSnapshot(snapshotPath);
+
+    QuakeStyleConsole reader;
+    Label readLabels[] = {{"before"}, {"before"}, {"before"}, {"before"}};
+    reader.commandExecute("var snap_words before", out);
+    reader.commandExecute("var snap_quoted before", out);
+
+    for (int i = 0; i < 4; i++)
+    {
+        reader.bindCVar("snap_label" + std::to_string(i), readLabels[i]);
+    }
+
+    const QuakeStyleConsole::SnapshotResult replay = reader.loadSnapshot(snapshotPath, out);
+
+    std::ostringstream echoed;
+    reader.commandExecute("echo snap_words", echoed);
+    reader.commandExecute("echo snap_quoted", echoed);
+
+    std::remove(snapshotPath);
+
+    const bool replayPass = replay.replayed == 3 && replay.skipped == 3 && echoed.str().find("\ntwo words\n") != std::string::npos &&
+                            echoed.str().find("\nbefore\n") != std::string::npos && readLabels[0].text == "red green" &&
+                            readLabels[1].text == labels[1].text && readLabels[2].text == "before" && readLabels[3].text == "before";
+
+    std::clog << (replayPass ? "[pass] " : "[FAIL] ") << "replayed strings keep their spaces, and strings and custom text a set line can't hold are skipped rather than mangled" << std::endl;
+
+    return pass && replayPass;
+}
+
+/// binding 3000 commands with literal help text, against the same text handed over as std::strings
+bool helpBenchmark()
+{
+    std::clog << "\n-- help text for 3000 commands --" << std::endl;
+
+    const int commandCount = 3000;
+
+    std::vector<std::string> names;
+
+    for (int i = 0; i < commandCount; i++)
+    {
+        names.push_back("helpCommand" + std::to_string(i));
+    }
+
+    QuakeStyleConsole literal;
+    QuakeStyleConsole copied;
+
+    const std::size_t literalStart = AllocationProbe::allocations;
+
+    for (const std::string &name : names)
+    {
+        literal.bindCommand(name, addToTotal, HelpText::borrow("type helpCommand <a> <b> to add a and b to the running total, which nothing ever reads"));
+    }
+
+    const std::size_t literalAllocations = AllocationProbe::allocations - literalStart;
+    const std::size_t copiedStart = AllocationProbe::allocations;
+
+    for (const std::string &name : names)
+    {
+        copied.bindCommand(name, addToTotal, std::string("type helpCommand <a> <b> to add a and b to the running total, which nothing ever reads"));
+    }
+
+    const std::size_t copiedAllocations = AllocationProbe::allocations - copiedStart;
+
+    const QuakeStyleConsole::HelpStats literalStats = literal.helpStats();
+    const QuakeStyleConsole::HelpStats copiedStats = copied.helpStats();
+
+    if (AllocationProbe::installed)
+    {
+        std::clog << "allocations binding with borrowed literals : " << literalAllocations << ", with std::strings : " << copiedAllocations << std::endl;
+    }
+
+    std::clog << "help bytes borrowed from literals : " << literalStats.borrowedBytes << ", copied : " << literalStats.copiedBytes << std::endl;
+    std::clog << "help bytes copied from std::strings : " << copiedStats.copiedBytes << " in " << copiedStats.copies << " allocations" << std::endl;
+
+    // help written into a buffer that's reused straight after binding has to have been copied
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "adds %d to the total", 42);
+    literal.bindCommand("bufferHelp", addToTotal, buffer);
+    std::snprintf(buffer, sizeof(buffer), "overwritten");
+
+    const bool pass = literalStats.copies == 0 && copiedStats.copies >= std::size_t(commandCount) && literal.helpText("helpCommand42").size() &&
+                      literal.helpText("bufferHelp") == "adds 42 to the total";
+
+    std::clog << (pass ? "[pass] " : "[FAIL] ") << "borrowed help isn't copied, and help from a char buffer is" << std::endl;
+
+    return pass;
+}
+
+/// Tab completion over 40k names : the sorted name index against scanning the command and cvar tables
+bool completionBenchmark()
+{
+    std::clog << "\n-- completing a prefix among 40k symbols --" << std::endl;
+
+    const int symbolCount = 40000;
+
+    std::vector<int> values(symbolCount / 2);
+    QuakeStyleConsole console;
+
+    for (int i = 0; i < symbolCount / 2; i++)
+    {
+        console.bindCommand("cmp_command" + std::to_string(i), addToTotal);
+        console.bindCVar("cmp_var" + std::to_string(i), values[i]);
+    }
+
+    const std::string_view prefix = "CMP_VAR1234";
+    const int queries = 100;
+
+    // what completion used to do : compare every name, copying the matches
+    std::vector<std::string> scanned;
+
+    auto scanPrefix = [&](std::string_view name) {
+        if (name.size() >= prefix.size() &&
+            std::equal(prefix.begin(), prefix.end(), name.begin(), [](char a, char b) { return std::tolower((unsigned char)a) == std::tolower((unsigned char)b); }))
+        {
+            scanned.push_back(std::string(name));
+        }
+    };
+
+    double scan = nanosecondsPer(queries, [&]() {
+        for (int q = 0; q < queries; q++)
+        {
+            scanned.clear();
+
+            for (auto it = console.getCommandTable().begin(); it != console.getCommandTable().end(); ++it)
+            {
+                scanPrefix(it->first);
+            }
+
+            for (auto it = console.getCVarTable().begin(); it != console.getCVarTable().end(); ++it)
+            {
+                scanPrefix(it->first);
+            }
+        }
+    });
+
+    std::vector<QuakeStyleConsole::SymbolID> matches;
+    std::size_t common = 0;
+
+    console.completeName(prefix, matches); // the first query sorts the names bound so far
+    double indexed = nanosecondsPer(queries, [&]() {
+        for (int q = 0; q < queries; q++)
+        {
+            matches.clear();
+            common = console.completeName(prefix, matches);
+        }
+    });
+
+    std::clog << "table scan : " << scan / 1e3 << " us, name index : " << indexed / 1e3 << " us (" << matches.size() << " matches)" << std::endl;
+
+    const bool pass = matches.size() == scanned.size() && matches.size() == 11 && common == prefix.size();
+
+    std::clog << (pass ? "[pass] " : "[FAIL] ") << "the name index finds the same matches as a scan" << std::endl;
+
+    return pass;
+}
+
+/// fuzzy completion as you type over 50k names
+bool fuzzyBenchmark()
+{
+    std::clog << "\n-- fuzzy completion over 50k names --" << std::endl;
+
+    const char *words[] = {"render", "sound", "client", "server", "net", "input", "mouse", "gamma", "shadow",
+                           "light", "fog", "draw", "debug", "max", "min", "rate", "scale", "speed"};
+    const int wordCount = sizeof(words) / sizeof(words[0]);
+    const int nameCount = 50000;
+
+    std::vector<int> values(nameCount / 2);
+    QuakeStyleConsole console;
+
+    for (int i = 0; i < nameCount; i++)
+    {
+        const std::string name = std::string(words[(i * 7) % wordCount]) + "_" + words[(i / wordCount) % wordCount] + std::to_string(i);
+
+        if (i % 2)
+        {
+            console.bindCommand(name, addToTotal);
+        }
+        else
+        {
+            console.bindCVar(name, values[i / 2]);
+        }
+    }
+
+    console.bindCommand("r_shadowQuality", addToTotal);
+
+    std::vector<QuakeStyleConsole::FuzzyMatch> matches;
+    console.fuzzyComplete("x", matches); // packs the names
+
+    // each keystroke of typing rsq, then a few other queries.  Rebinding a command makes each one start over from every name
+    const char *queries[] = {"r", "rs", "rsq", "sh", "shsp", "fogdr", "render_speed"};
+    const int repeats = 50;
+    bool found = true;
+
+    for (const char *query : queries)
+    {
+        double ns = nanosecondsPer(repeats, [&]() {
+            for (int i = 0; i < repeats; i++)
+            {
+                console.bindCommand("r_shadowQuality", addToTotal);
+                matches.clear();
+                console.fuzzyComplete(query, matches, 16);
+            }
+        });
+
+        if (matches.empty())
+        {
+            found = false;
+            continue;
+        }
+
+        std::clog << '"' << query << "\" : " << ns / 1e3 << " us, best " << console.getSymbol(matches[0].id).name << std::endl;
+    }
+
+    matches.clear();
+    console.fuzzyComplete("rsq", matches, 16);
+
+    bool pass = found && matches.size() && console.getSymbol(matches[0].id).name == "r_shadowQuality";
+
+    std::clog << (pass ? "[pass] " : "[FAIL] ") << "rsq ranks r_shadowQuality first" << std::endl;
+
+    // typing a name one letter at a time, asking on each keystroke and then again on each frame until the next one
+    const std::string typed = "shadow_speed";
+    const int framesPerKey = 5;
+    std::vector<std::vector<QuakeStyleConsole::FuzzyMatch>> fresh(typed.size()), narrowed(typed.size());
+
+    double scratchNs = nanosecondsPer(1, [&]() {
+        for (std::size_t n = 1; n <= typed.size(); n++)
+        {
+            for (int frame = 0; frame < framesPerKey; frame++)
+            {
+                console.bindCommand("r_shadowQuality", addToTotal);
+                fresh[n - 1].clear();
+                console.fuzzyComplete(std::string_view(typed).substr(0, n), fresh[n - 1], 16);
+            }
+        }
+    });
+
+    console.bindCommand("r_shadowQuality", addToTotal);
+
+    double narrowNs = nanosecondsPer(1, [&]() {
+        for (std::size_t n = 1; n <= typed.size(); n++)
+        {
+            for (int frame = 0; frame < framesPerKey; frame++)
+            {
+                narrowed[n - 1].clear();
+                console.fuzzyComplete(std::string_view(typed).substr(0, n), narrowed[n - 1], 16);
+            }
+        }
+    });
+
+    bool same = true;
+
+    for (std::size_t n = 0; n < typed.size(); n++)
+    {
+        same &= fresh[n].size() == narrowed[n].size() &&
+                std::equal(fresh[n].begin(), fresh[n].end(), narrowed[n].begin(),
+                           [](const QuakeStyleConsole::FuzzyMatch &a, const QuakeStyleConsole::FuzzyMatch &b) { return a.id == b.id && a.score == b.score; });
+    }
+
+    std::clog << "typing \"" << typed << "\", " << framesPerKey << " frames a key : from scratch " << scratchNs / 1e3 << " us, narrowing "
+              << narrowNs / 1e3 << " us (" << scratchNs / narrowNs << "x)" << std::endl;
+
+    pass &= same;
+
+    std::clog << (same ? "[pass] " : "[FAIL] ") << "narrowing finds what starting over finds on every keystroke" << std::endl;
+
+    // names that tie on score are cut by name, so the list is the same whichever order they were bound in
+    QuakeStyleConsole forward, backward;
+
+    for (int i = 0; i < 40; i++)
+    {
+        forward.bindCommand("tie_name" + std::to_string(i), addToTotal);
+        backward.bindCommand("tie_name" + std::to_string(39 - i), addToTotal);
+    }
+
+    std::vector<QuakeStyleConsole::FuzzyMatch> forwardMatches, backwardMatches;
+    forward.fuzzyComplete("tie", forwardMatches, 5);
+    backward.fuzzyComplete("tie", backwardMatches, 5);
+
+    bool stable = forwardMatches.size() == 5 && backwardMatches.size() == 5;
+
+    for (std::size_t i = 0; stable && i < forwardMatches.size(); i++)
+    {
+        stable = forward.getSymbol(forwardMatches[i].id).name == backward.getSymbol(backwardMatches[i].id).name;
+    }
+
+    pass &= stable;
+
+    std::clog << (stable ? "[pass] " : "[FAIL] ") << "ties are cut by name, not by binding order" << std::endl;
+
+    return pass;
+}
+
+/// several threads issuing commands : through a global mutex around commandExecute, against submit() and a draining owner thread
+bool queueBenchmark()
+{
+    std::clog << "\n-- 4 threads x 20000 commands --" << std::endl;
+
+    const int threadCount = 4;
+    const int perThread = 20000;
+
+    NullBuf nb;
+    std::ostream out(&nb);
+
+    int sum = 0;
+
+    // room for every command, so producers never wait on the owner and the times below are what the producers pay
+    QuakeStyleConsole console(QuakeStyleConsole::defaultHistorySize, threadCount * perThread);
+    console.bindCommand("addSum", std::function<void(int)>([&sum](int x) { sum += x; }));
+
+    std::mutex consoleMutex;
+
+    auto runThreads = [&](auto &&body) {
+        std::vector<std::thread> threads;
+
+        for (int t = 0; t < threadCount; t++)
+        {
+            threads.emplace_back(body);
+        }
+
+        for (std::thread &t : threads)
+        {
+            t.join();
+        }
+    };
+
+    double locked = nanosecondsPer(threadCount * perThread, [&]() {
+        runThreads([&]() {
+            for (int i = 0; i < perThread; i++)
+            {
+                std::lock_guard<std::mutex> lock(consoleMutex);
+                console.commandExecute("addSum 1", out, QuakeStyleConsole::EXECUTE_SILENT);
+            }
+        });
+    });
+
+    const bool lockedPass = (sum == threadCount * perThread);
+
+    sum = 0;
+    std::atomic<int> completed{0};
+    std::atomic<int> rejected{0};
+
+    double submitted = nanosecondsPer(threadCount * perThread, [&]() {
+        runThreads([&]() {
+            for (int i = 0; i < perThread; i++)
+            {
+                // the last line from each thread asks for a completion callback
+                QuakeStyleConsole::CompletionFunc done;
+                if (i == perThread - 1)
+                {
+                    done = [&completed](std::string_view, const QuakeStyleConsole::BatchResult &r) { completed += (r.errors == 0); };
+                }
+
+                rejected += !console.submit("addSum 1", std::move(done));
+            }
+        });
+    });
+
+    // the owner thread drains, as it would once per frame
+    double drained = nanosecondsPer(threadCount * perThread, [&]() {
+        console.drain(out, std::numeric_limits<std::size_t>::max(), std::chrono::microseconds::max(), QuakeStyleConsole::EXECUTE_SILENT);
+    });
+
+    const bool queuePass = (sum == threadCount * perThread) && (completed == threadCount) && (rejected == 0);
+
+    std::clog << "mutex around commandExecute, producer side : " << locked << " ns per command" << std::endl;
+    std::clog << "submit, producer side : " << submitted << " ns per command" << std::endl;
+    std::clog << "drain, owner side : " << drained << " ns per command" << std::endl;
+    std::clog << (lockedPass && queuePass ? "[pass] " : "[FAIL] ") << "every command ran once, and every completion callback fired" << std::endl;
+
+    // a job's progress lines show up while it's still running, not when it ends
+    std::atomic<bool> seen{false};
+    std::shared_ptr<ConsoleJob> job = console.startJob("progress", [&seen](ConsoleJob &j) {
+        j.out() << "step " << 1 << '\n' << "still going";
+        while (!seen && !j.cancelled())
+        {
+            std::this_thread::yield();
+        }
+    });
+
+    std::string progress;
+    const auto giveUp = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+    while (progress.find('\n') == std::string::npos && std::chrono::steady_clock::now() < giveUp)
+    {
+        job->takeOutput(progress);
+    }
+
+    const bool linePass = progress == "step 1\n" && job->state() != ConsoleJob::JOB_DONE;
+    seen = true;
+
+    std::clog << (linePass ? "[pass] " : "[FAIL] ") << "job output is handed over a line at a time" << std::endl;
+
+    return lockedPass && queuePass && linePass;
+}
+
+int main()
+{
+    std::clog << "VirtuosoConsole benchmark program." << std::endl;
+
+    Counter counter;
+
+    QuakeStyleConsole console;
+
+    console.bindCVar("health", health);
+    console.bindCVar("gravity", gravity);
+    console.bindCVar("count", counter.count);
+    console.bindCommand("add", addToTotal);
+    console.bindMemberCommand("counterAdd", counter, &Counter::add);
+    console.setAlias("burst", "counterAdd 1; add 1 2; set health 5");
+
+    bool pass = allocationTests(console);
+
+    timings(console);
+
+    pass &= dispatchBenchmark(console);
+
+    pass &= cvarPollBenchmark();
+
+    pass &= batchBenchmark(console);
+
+    pass &= fileBenchmark(console);
+
+    pass &= scriptCacheBenchmark(console);
+
+    pass &= steppedScriptBenchmark(console);
+
+    pass &= configBenchmark();
+
+    pass &= snapshotBenchmark();
+
+    pass &= helpBenchmark();
+
+    pass &= completionBenchmark();
+
+    pass &= fuzzyBenchmark();
+
+    pass &= queueBenchmark();
+
+    parserBenchmark();
+
+    return pass ? 0 : 1;
+}
@@ -9,6 +9,18 @@ void printSum(const int& a, const int& b)
     std::cout<<a+b<<std::endl;
 }
 
+float gravity = 9.8f; // a global declared to the console at compile time below
+
+void printGravity(const float& scale)
+{
+    std::clog << "Scaled gravity is " << gravity * scale << std::endl;
+}
+
+// commands and variables declared at compile time, no bind calls needed
+VIRTUOSO_CONSOLE_STATIC_TABLE(staticCommands,
+    VIRTUOSO_CONSOLE_CVAR("gravity", gravity, "World gravity.  Example variable declared with VIRTUOSO_CONSOLE_STATIC_TABLE"),
+    VIRTUOSO_CONSOLE_COMMAND("scaledGravity", printGravity, "Prints gravity times a scale factor.  Example command declared with VIRTUOSO_CONSOLE_STATIC_TABLE"));
+
 class Adder
 {
     std::string str;
@@ -47,7 +59,7 @@ int main()
     
     std::function <void (void)> printHistory = [&console]()
     {
-        for (int i = 0; i < console.historyBuffer().size(); i++)
+        for (std::size_t i = 0; i < console.historyBuffer().size(); i++)
         {
             std::clog << console.historyBuffer()[i] << std::endl;
         }
@@ -57,6 +69,22 @@ int main()
 
     console.bindMemberCommand("sumFiveValues", a, &Adder::add, "Given five integers as input, sum them all.  This demonstrates bindMemberCommand() using an object");
     
+    //binding a slow command to run on a worker thread.  Its output shows up as lines are entered, and "jobs" lists it
+    console.bindAsyncCommand("countPrimes", std::function<void(ConsoleJob&, int)>([](ConsoleJob& job, int limit)
+    {
+        int count = 0;
+        for (int n = 2; n < limit && !job.cancelled(); n++)
+        {
+            bool prime = true;
+            for (int d = 2; d * d <= n && prime; d++)
+            {
+                prime = (n % d) != 0;
+            }
+            count += prime;
+        }
+        job.out() << "There are " << count << " primes below " << limit << std::endl;
+    }), "Counts the primes below a number on a worker thread.  Example command bound with bindAsyncCommand()");
+
     //bind the variable to the console
 	console.bindCVar("health", health, "Player health.  Example variable bound from c++ code using bindCVar()");
 
@@ -69,6 +97,9 @@ int main()
 
         // you can pass in whatever istream and ostream you want
         console.commandExecute(std::cin, std::clog);
+
+        // each line typed counts as a frame here, so "wait 2" in a script resumes after two more lines
+        console.tick(std::clog);
 	}
 
     std::cout<<"Saving history file"<<std::endl;
@@ -186,6 +186,8 @@ struct ConsoleApplication : public GLFWApplication
         
         bool pople = true;
         console3.render("console 2 implementation", &pople);
+
+        console3.con.tick(console3); // resumes scripts paused with wait
         
         ImGui::EndFrame();
         ImGui::Render();